@@ -19,14 +19,14 @@ project "Atomos"
         "./lib/glew-2.0.0/include",
 	    "./lib/ImGui",
         "./lib/glm",
+        "%{wks.location}/AtomosCore/src",
+        "%{wks.location}/AtomosCore/src/physics",
         "src"
     }
    
     
     links {
-        "opengl32",
-        "glew32s",
-        "glfw3",
+        "AtomosCore",
         "ImGui"
     }    
 
@@ -48,14 +48,20 @@ project "Atomos"
     print ("test")
 
 
+    --the bundled glfw and glew are Windows builds, elsewhere the system packages are linked
+    filter "system:windows"
+        links { "opengl32", "glew32s", "glfw3" }
+    filter "system:linux"
+        links { "GL", "GLEW", "glfw" }
+
     --for 32 bit use these library paths
-    filter "architecture:x86"
+    filter { "system:windows", "architecture:x86" }
         libdirs { 
             "./lib/glfw-3.2.1/win32/lib",
             "./lib/glew-2.0.0/win32/lib"
         }
     --for x64 use these
-    filter "architecture:x64"
+    filter { "system:windows", "architecture:x64" }
         libdirs { 
             "./lib/glfw-3.2.1/x64/lib",
             "./lib/glew-2.0.0/x64/lib"
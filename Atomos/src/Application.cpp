@@ -7,16 +7,43 @@
 #include <glm.hpp>
 #include "physics/Physics.hpp"
 #include "Timer.hpp"
+#include "Tracer.hpp"
+#include "SimulationView.hpp"
 #include "Application.hpp"
 
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
 
 
 #define SIMULATION_WINDOW_WIDTH 800
 #define SIMULATION_WINDOW_HEIGHT 700
 
-#define TIME_STEP 1.f / 60.f
+// the pipelined physics thread steps SIMULATION_RATE times a second of wall time, TIME_STEP each
+#define SIMULATION_RATE 60
+#define TIME_STEP (1.f / SIMULATION_RATE)
+
+// any of SceneLibrary::names(), built to fill the simulation window with up to SCENE_OBJECTS objects
+#define SIMULATION_SCENE "fountain"
+#define SCENE_OBJECTS 5
+
+// run physics on its own thread and draw whichever snapshot it published last
+#define PIPELINED_PHYSICS 1
+
+// scraped by the monitoring agent, rewritten every METRICS_INTERVAL simulation frames
+#define METRICS_FILE "atomos_metrics.prom"
+#define METRICS_INTERVAL 60
+
+// chrome trace of TRACE_FRAMES simulation frames, captured from the metrics panel
+#define TRACE_FILE "atomos_trace.json"
+#define TRACE_FRAMES 120
+// the last REWIND_SECONDS of simulation stay in memory for the rewind scrubber, one in REWIND_KEYFRAME_INTERVAL frames
+// whole; one frame more than those seconds hold, so the frame exactly REWIND_SECONDS back can still be restored
+#define REWIND_SECONDS 10
+#define REWIND_FRAMES (REWIND_SECONDS * SIMULATION_RATE + 1)
+#define REWIND_KEYFRAME_INTERVAL (SIMULATION_RATE / 2)
 
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);	
@@ -28,10 +55,10 @@ const unsigned int SCR_HEIGHT = 1080;
 
 bool debug;
 Timer timer;
-float frames = 0.f;
-float deltaTime = 0.f;
 
-PhysicsController* physics; 
+DefaultPhysicsController* physics; 
+SimulationView* view;
+std::atomic<bool> simulating = false;
 
 Application::Application() {
     init();
@@ -84,13 +111,26 @@ void Application::init() {
 	// Setup Platform/Renderer backends
 	ImGui_ImplGlfw_InitForOpenGL(window, true);          // Second param install_callback=true will install GLFW callbacks and chain to existing ones.
 	ImGui_ImplOpenGL3_Init();
-	physics = new PhysicsController(SIMULATION_WINDOW_WIDTH, SIMULATION_WINDOW_HEIGHT);
+	physics = new DefaultPhysicsController(SIMULATION_WINDOW_WIDTH, SIMULATION_WINDOW_HEIGHT);
+	Scene scene;
+	if (SceneLibrary::make(SIMULATION_SCENE, SIMULATION_WINDOW_WIDTH, SIMULATION_WINDOW_HEIGHT, SCENE_OBJECTS, scene)) physics->loadScene(scene);
+	else std::cout << "Unknown scene: " << SIMULATION_SCENE << std::endl;
+	view = new SimulationView(physics);
+	physics->exportMetrics(METRICS_FILE, METRICS_INTERVAL);
+	physics->exportTrace(TRACE_FILE, TRACE_FRAMES);
+	physics->keepRewindHistory(REWIND_FRAMES, REWIND_KEYFRAME_INTERVAL);
 }
 
 void Application::run() {
+	if (PIPELINED_PHYSICS) {
+		runPipelined();
+		return;
+	}
+
+	Tracer::setThreadName("main");
 	timer.start();
 	printf("Window memory location: %x", window);
-    while (window) {
+    while (!glfwWindowShouldClose(window)) {
 		glfwPollEvents();
 		processInput(window);
 		
@@ -100,6 +140,22 @@ void Application::run() {
     }
 }
 
+// the render loop stays on the main thread with the GL context, physics gets a thread of its own
+void Application::runPipelined() {
+	simulating = true;
+	std::thread physicsThread(&Application::simulate, this);
+
+    while (!glfwWindowShouldClose(window)) {
+		glfwPollEvents();
+		processInput(window);
+
+		onDisplay();
+    }
+
+	simulating = false;
+	physicsThread.join();
+}
+
 void Application::onDisplay() {
 
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -109,7 +165,9 @@ void Application::onDisplay() {
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 
-		physics->displaySimulation();
+		view->displaySimulation();
+		view->displayMetrics();
+		view->displayRewind();
         
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -122,12 +180,29 @@ void Application::onUpdate()
     // render
     // ------
 
-    deltaTime = timer.readmarkSplitMillis() / 1000;
-    frames = 1.f / deltaTime;
+    float deltaTime = timer.readmarkSplitMillis() / 1000;
     physics->update(deltaTime);
 
 }
 
+// Steps on a fixed period rather than as fast as it can, so every per-frame consumer, the snapshot, the
+// shared ring, the trajectory and the rewind buffer, sees SIMULATION_RATE frames a second. A step that
+// overruns its period starts the schedule over instead of stepping back to back to catch up.
+void Application::simulate() {
+	Tracer::setThreadName("physics");
+	using Clock = std::chrono::steady_clock;
+	Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(TIME_STEP));
+	Clock::time_point nextTick = Clock::now();
+	while (simulating) {
+		physics->update(TIME_STEP);
+
+		nextTick += period;
+		Clock::time_point now = Clock::now();
+		if (nextTick < now) nextTick = now;
+		std::this_thread::sleep_until(nextTick);
+	}
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
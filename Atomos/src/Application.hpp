@@ -5,6 +5,7 @@ class Application {
 
 protected:
     void run();
+    void runPipelined();
 
 public:
     Application();
@@ -12,4 +13,5 @@ public:
     void init();
     void onDisplay();
     void onUpdate();
+    void simulate();
 };
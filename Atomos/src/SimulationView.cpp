@@ -0,0 +1,162 @@
+#include "SimulationView.hpp"
+#include "physics/Physics.hpp"
+#include "Tracer.hpp"
+#include "imgui.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+
+constexpr int IMGUI_FRAME_MARGIN = 4;
+constexpr float LOD_CELL_PIXELS = 4.f;		// cells drawn smaller than this are merged into heatmap blocks
+constexpr float MIN_ZOOM = .125f;
+constexpr float MAX_ZOOM = 32.f;
+constexpr float ZOOM_STEP = 1.25f;			// per notch of the mouse wheel
+
+
+SimulationView::SimulationView(PhysicsWorld* world_) : world(world_) {}
+
+void SimulationView::setView(float originX_, float originY_, float zoom_) {
+	zoom = std::clamp(zoom_, MIN_ZOOM, MAX_ZOOM);
+	originX = originX_;
+	originY = originY_;
+}
+
+void SimulationView::handleViewInput() {
+	if (!ImGui::IsWindowHovered()) return;
+	ImGuiIO& io = ImGui::GetIO();
+	ImVec2 windowPos = ImGui::GetWindowPos();
+	float mouseX = io.MousePos.x - windowPos.x;
+	float mouseY = io.MousePos.y - windowPos.y;
+
+	if (io.MouseWheel != 0.f) {
+		// the world point under the cursor stays under it
+		float anchorX = originX + mouseX / zoom;
+		float anchorY = originY + mouseY / zoom;
+		zoom = std::clamp(zoom * powf(ZOOM_STEP, io.MouseWheel), MIN_ZOOM, MAX_ZOOM);
+		originX = anchorX - mouseX / zoom;
+		originY = anchorY - mouseY / zoom;
+	}
+	if (ImGui::IsMouseDragging(ImGuiMouseButton_Right)) {
+		originX -= io.MouseDelta.x / zoom;
+		originY -= io.MouseDelta.y / zoom;
+	}
+	if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) setView(0.f, 0.f, 1.f);
+}
+
+void SimulationView::displaySimulation() {
+	float width = static_cast<float>(world->getWidth());
+	float height = static_cast<float>(world->getHeight());
+	ImGui::SetNextWindowSize({ width + IMGUI_FRAME_MARGIN, height + IMGUI_FRAME_MARGIN });
+	ImGui::SetNextWindowContentSize({ width, height });
+	ImGui::Begin("balls", 0, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+	handleViewInput();
+	const PhysicsWorld::RenderSnapshot& snapshot = world->readSnapshot();
+	const PhysicsWorld::RenderGrid& grid = snapshot.grid;
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	ImVec2 posWindowOffset = ImGui::GetWindowPos();
+	auto toScreen = [&](float x, float y) {
+		return ImVec2{ (x - originX) * zoom + posWindowOffset.x, (y - originY) * zoom + posWindowOffset.y };
+	};
+
+	if (grid.cells.empty()) {
+		// nothing published yet
+		ImGui::End();
+		return;
+	}
+	bool compact = snapshot.compact.size() > 0;
+	// a margin of one cell catches objects that hang over from a cell just out of view
+	float cellPixels = grid.cellSize * zoom;
+	int block = cellPixels >= LOD_CELL_PIXELS ? 1 : static_cast<int>(ceilf(LOD_CELL_PIXELS / cellPixels));
+	int lowX = std::max(static_cast<int>(floorf(originX / grid.cellSize)) - 1, 0) / block * block;
+	int lowY = std::max(static_cast<int>(floorf(originY / grid.cellSize)) - 1, 0) / block * block;
+	int highX = std::min(static_cast<int>(ceilf((originX + width / zoom) / grid.cellSize)) + 1, static_cast<int>(grid.columns));
+	int highY = std::min(static_cast<int>(ceilf((originY + height / zoom) / grid.cellSize)) + 1, static_cast<int>(grid.rows));
+
+	for (int y = lowY; y < highY; y += block) {
+		for (int x = lowX; x < highX; x += block) {
+			const PhysicsWorld::RenderCell& cell = grid.cells[static_cast<size_t>(y) * grid.columns + x];
+			if (block == 1 && cell.count <= cellPixels * cellPixels) {
+				for (uint32_t k = cell.first; k < cell.first + cell.count; k++) {
+					uint32_t i = grid.objects[k];
+					if (compact) {
+						CompactParticleStore::Particle obj = snapshot.compact.get(i);
+						drawList->AddCircleFilled(toScreen(obj.position.x, obj.position.y), obj.radius * zoom, obj.color);
+					}
+					else {
+						const PhysicsWorld::RenderObject& obj = snapshot.objects[i];
+						drawList->AddCircleFilled(toScreen(obj.position.x, obj.position.y), obj.radius * zoom, obj.color);
+					}
+				}
+				continue;
+			}
+
+			// the block's cells weighted by how many objects they hold, opaque once they would cover it
+			uint32_t count = 0;
+			float coverage = 0.f;
+			float channels[4] = {};
+			for (int by = y; by < std::min(y + block, highY); by++) {
+				for (int bx = x; bx < std::min(x + block, highX); bx++) {
+					const PhysicsWorld::RenderCell& part = grid.cells[static_cast<size_t>(by) * grid.columns + bx];
+					count += part.count;
+					coverage += part.coverage;
+					for (int c = 0; c < 4; c++) channels[c] += ((part.color >> (8 * c)) & 0xff) * static_cast<float>(part.count);
+				}
+			}
+			if (!count) continue;
+			uint32_t color = 0;
+			for (int c = 0; c < 3; c++) color |= static_cast<uint32_t>(channels[c] / count) << (8 * c);
+			float alpha = std::min(coverage / (block * block), 1.f) * (channels[3] / count);
+			color |= static_cast<uint32_t>(alpha) << 24;
+			drawList->AddRectFilled(toScreen(x * grid.cellSize, y * grid.cellSize), toScreen((x + block) * grid.cellSize, (y + block) * grid.cellSize), color);
+		}
+	}
+
+	ImGui::End();
+}
+
+void SimulationView::displayMetrics() {
+	const PhysicsWorld::FrameMetrics& frame = world->readSnapshot().metrics;
+
+	ImGui::Begin("metrics");
+	ImGui::Text("frame %llu  %.2f ms", static_cast<unsigned long long>(frame.frame), frame.frameMillis);
+	ImGui::Text("objects %u  moving %u  resting %u", frame.objects, frame.objectsMoving, frame.objectsResting);
+	ImGui::Text("spawned %u  destroyed %u", frame.objectsSpawned, frame.objectsDestroyed);
+	ImGui::Text("substeps %u  max speed %.1f", frame.substeps, frame.maxSpeed);
+	ImGui::Separator();
+	ImGui::Text("pair tests %llu  contacts %llu", static_cast<unsigned long long>(frame.pairTests), static_cast<unsigned long long>(frame.contacts));
+	ImGui::Text("events %llu  discarded %llu", static_cast<unsigned long long>(frame.eventsProcessed), static_cast<unsigned long long>(frame.eventsDiscarded));
+	ImGui::Text("neighbour list builds %llu", static_cast<unsigned long long>(frame.listBuilds));
+	ImGui::Separator();
+	ImGui::Text("occupied cells %u  max per cell %u", frame.occupiedCells, frame.maxObjectsPerCell);
+	float occupancy[PhysicsWorld::OCCUPANCY_BUCKETS];
+	for (int i = 0; i < PhysicsWorld::OCCUPANCY_BUCKETS; i++) occupancy[i] = static_cast<float>(frame.cellOccupancy[i]);
+	ImGui::PlotHistogram("cells by objects", occupancy, PhysicsWorld::OCCUPANCY_BUCKETS, 0, "1 .. 8+", 0.f, FLT_MAX, ImVec2(0, 60));
+	ImGui::Separator();
+	ImGui::Text("pool tasks %llu  wait %.3f ms  busy %.3f ms", static_cast<unsigned long long>(frame.tasksRun), frame.taskWaitMillis, frame.taskBusyMillis);
+	if (!world->getTracePath().empty()) {
+		ImGui::Separator();
+		if (Tracer::capturing()) ImGui::Text("tracing %u frames to %s", world->getTraceFrames(), world->getTracePath().c_str());
+		else if (ImGui::Button("capture trace")) world->captureTrace();
+	}
+	ImGui::End();
+}
+
+void SimulationView::displayRewind() {
+	uint64_t oldest = world->getOldestRewindFrame();
+	uint64_t newest = world->getNewestRewindFrame();
+	if (!oldest) return;
+
+	ImGui::Begin("rewind");
+	bool paused = world->isPaused();
+	if (ImGui::Checkbox("paused", &paused)) world->setPaused(paused);
+	// while running the slider follows the simulation, while paused it stays where it was dragged
+	if (!paused) scrubFrame = newest;
+	scrubFrame = std::clamp(scrubFrame, oldest, newest);
+	if (ImGui::SliderScalar("frame", ImGuiDataType_U64, &scrubFrame, &oldest, &newest)) {
+		world->setPaused(true);
+		world->requestRewind(scrubFrame);
+	}
+	ImGui::Text("holding frames %llu .. %llu", static_cast<unsigned long long>(oldest), static_cast<unsigned long long>(newest));
+	ImGui::End();
+}
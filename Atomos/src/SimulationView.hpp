@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+class PhysicsWorld;
+
+
+// ImGui windows over a PhysicsWorld. Everything is read from the snapshots the world publishes,
+// so a view may draw on a different thread than the one running update().
+class SimulationView {
+	PhysicsWorld* world;
+	uint64_t scrubFrame = 0;
+
+	// world position at the top left corner of the simulation window, and pixels per world unit
+	float originX = 0.f;
+	float originY = 0.f;
+	float zoom = 1.f;
+
+	void handleViewInput();
+
+public:
+	SimulationView(PhysicsWorld* world_);
+	// Draws only the cells of the snapshot's grid that fall inside the window. Cells drawn smaller than a
+	// few pixels are merged into blocks, and a block, or a cell holding more objects than it covers pixels,
+	// becomes one quad in its objects' mean colour, so the cost is bounded by the window, not the objects.
+	// The mouse wheel zooms about the cursor, dragging with the right button pans, a double click resets.
+	void displaySimulation();
+	void setView(float originX_, float originY_, float zoom_);
+	void displayMetrics();
+	// pauses the world and asks it to rewind to the frame under the slider, see PhysicsWorld::requestRewind
+	void displayRewind();
+};
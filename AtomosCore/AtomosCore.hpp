@@ -0,0 +1,11 @@
+#pragma once
+
+// Headless engine: link AtomosCore and drive a controller yourself.
+//   step       controller.update(dt)
+//   spawn      spawnObject, addSpawner, loadScene with a Scene from SceneLibrary
+//   query      queryObjects, getObject, getNumObjects
+//   readback   readParticles for flat arrays, readSnapshot for what the last frame published
+//   export     exportSharedFrames to let other processes map every frame, see SharedFrameRing
+//   record     recordTrajectory to stream every frame to a file, TrajectoryReader to read it back
+//   rewind     keepRewindHistory to hold the last frames in memory, restoreFrame to go back to one
+#include "src/physics/Physics.hpp"
@@ -0,0 +1,38 @@
+project "AtomosCore"
+    kind "StaticLib"
+    language "C++"
+    cppdialect "C++20"
+    staticruntime "off"
+
+    targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+
+    files {
+        "src/**.cpp",
+        "src/**.hpp",
+        "AtomosCore.hpp",
+	    "Build_AtomosCore.lua"
+    }
+
+    --the core only needs glm, so it builds anywhere without a window or a GL context
+    includedirs {
+        "%{wks.location}/Atomos/lib/glm",
+        "src",
+        "src/physics"
+    }
+
+    filter "configurations:Debug"
+        defines { "DEBUG" }
+        runtime "Debug"
+        symbols "On"
+
+    filter "configurations:Release"
+        defines { "RELEASE" }
+        runtime "Release"
+        optimize "On"
+        symbols "On"
+
+    filter { }
+
+    filter { "system:windows", "action:gmake2" }
+        buildoptions { "-M" }
+    filter { }
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+
+// Bounded lock-free queue for many producer threads and a single consumer.
+// Every slot carries a sequence number that tells producers whether it is free for their ticket
+// and tells the consumer whether the write to it has finished, so neither side ever takes a lock.
+// A push onto a full queue fails straight away and is counted rather than waiting for room.
+template <typename T>
+class CommandQueue {
+	struct Slot {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	std::unique_ptr<Slot[]> buffer;
+	size_t mask;
+
+	alignas(64) std::atomic<size_t> enqueuePosition = 0;
+	alignas(64) size_t dequeuePosition = 0;		// only the consumer touches this
+
+	alignas(64) std::atomic<uint64_t> numPushed = 0;
+	std::atomic<uint64_t> numRejected = 0;
+
+public:
+	// capacity is rounded up to a power of two
+	CommandQueue(size_t capacity) {
+		size_t size = 2;
+		while (size < capacity) size *= 2;
+		mask = size - 1;
+
+		buffer.reset(new Slot[size]);
+		for (size_t i = 0; i < size; i++) buffer[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	// safe from any thread
+	bool push(const T& value) {
+		Slot* slot;
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+		while (true) {
+			slot = &buffer[position & mask];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0) {
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+			}
+			else if (difference < 0) {
+				// the consumer has not freed this slot yet, the queue is full
+				numRejected.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else position = enqueuePosition.load(std::memory_order_relaxed);
+		}
+
+		slot->data = value;
+		slot->sequence.store(position + 1, std::memory_order_release);
+		numPushed.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// consumer thread only
+	bool pop(T& value) {
+		Slot& slot = buffer[dequeuePosition & mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition + 1) < 0) return false;
+
+		value = slot.data;
+		slot.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+		dequeuePosition++;
+		return true;
+	}
+
+	// consumer thread only, hands at most limit values to function and returns how many it took
+	template <typename F>
+	size_t drain(F&& function, size_t limit) {
+		T value;
+		size_t count = 0;
+		while (count < limit && pop(value)) {
+			function(value);
+			count++;
+		}
+		return count;
+	}
+
+	size_t capacity() const { return mask + 1; }
+	uint64_t pushed() const { return numPushed.load(std::memory_order_relaxed); }
+	uint64_t rejected() const { return numRejected.load(std::memory_order_relaxed); }
+};
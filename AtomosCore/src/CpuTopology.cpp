@@ -0,0 +1,182 @@
+#include "CpuTopology.hpp"
+
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <filesystem>
+#include <tuple>
+#include <cctype>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace {
+	// sysfs cpu lists look like "0-3,8,10-11"
+	std::vector<uint32_t> parseList(const std::string& text) {
+		std::vector<uint32_t> ids;
+		size_t at = 0;
+		while (at < text.size()) {
+			size_t end = text.find(',', at);
+			if (end == std::string::npos) end = text.size();
+			std::string range = text.substr(at, end - at);
+			size_t dash = range.find('-');
+			if (!range.empty() && std::isdigit(static_cast<unsigned char>(range[0]))) {
+				uint32_t low = std::stoul(range);
+				uint32_t high = dash == std::string::npos ? low : std::stoul(range.substr(dash + 1));
+				for (uint32_t id = low; id <= high; id++) ids.push_back(id);
+			}
+			at = end + 1;
+		}
+		return ids;
+	}
+
+	bool readText(const std::string& path, std::string& text) {
+		std::ifstream file(path);
+		return file && std::getline(file, text);
+	}
+
+	bool readNumber(const std::string& path, uint32_t& value) {
+		std::string text;
+		if (!readText(path, text) || text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+		value = std::stoul(text);
+		return true;
+	}
+
+	auto coreKey(const CpuTopology::Cpu& cpu) { return std::tie(cpu.node, cpu.package, cpu.core); }
+}
+
+
+CpuTopology CpuTopology::detect(const std::string& root) {
+	CpuTopology topology;
+#ifdef __linux__
+	std::string online;
+	if (readText(root + "/cpu/online", online)) {
+		for (uint32_t id : parseList(online)) {
+			std::string base = root + "/cpu/cpu" + std::to_string(id) + "/topology/";
+			Cpu cpu = { id, id, 0, 0, 0 };
+			readNumber(base + "core_id", cpu.core);
+			readNumber(base + "physical_package_id", cpu.package);
+			topology.cpus.push_back(cpu);
+		}
+
+		std::error_code error;
+		for (std::filesystem::directory_iterator entry(root + "/node", error), end; !error && entry != end; entry.increment(error)) {
+			std::string name = entry->path().filename().string();
+			if (name.size() <= 4 || name.compare(0, 4, "node") != 0 || !std::isdigit(static_cast<unsigned char>(name[4]))) continue;
+			uint32_t node = std::stoul(name.substr(4));
+			std::string list;
+			if (!readText(entry->path().string() + "/cpulist", list)) continue;
+			for (uint32_t id : parseList(list)) {
+				for (Cpu& cpu : topology.cpus) if (cpu.id == id) cpu.node = node;
+			}
+		}
+	}
+#endif
+	if (topology.cpus.empty()) {
+		uint32_t count = std::max(1u, std::thread::hardware_concurrency());
+		for (uint32_t i = 0; i < count; i++) topology.cpus.push_back({ i, i, 0, 0, 0 });
+	}
+
+	// number the hardware threads of every core in the order the OS numbers them
+	std::sort(topology.cpus.begin(), topology.cpus.end(), [](const Cpu& a, const Cpu& b) {
+		return std::tie(a.node, a.package, a.core, a.id) < std::tie(b.node, b.package, b.core, b.id);
+	});
+	for (size_t i = 0; i < topology.cpus.size(); i++) {
+		bool sameCore = i > 0 && coreKey(topology.cpus[i]) == coreKey(topology.cpus[i - 1]);
+		topology.cpus[i].sibling = sameCore ? topology.cpus[i - 1].sibling + 1 : 0;
+	}
+	std::sort(topology.cpus.begin(), topology.cpus.end(), [](const Cpu& a, const Cpu& b) { return a.id < b.id; });
+	return topology;
+}
+
+const CpuTopology& CpuTopology::get() {
+	static const CpuTopology topology = detect();
+	return topology;
+}
+
+uint32_t CpuTopology::numNodes() const {
+	std::vector<uint32_t> nodes;
+	for (const Cpu& cpu : cpus) if (std::find(nodes.begin(), nodes.end(), cpu.node) == nodes.end()) nodes.push_back(cpu.node);
+	return static_cast<uint32_t>(nodes.size());
+}
+
+uint32_t CpuTopology::numCores() const {
+	uint32_t cores = 0;
+	for (const Cpu& cpu : cpus) cores += cpu.sibling == 0;
+	return cores;
+}
+
+std::vector<uint32_t> CpuTopology::place(Placement placement, uint32_t numThreads) const {
+	std::vector<uint32_t> placed;
+	if (placement == UNPINNED || cpus.empty()) return placed;
+
+	std::vector<Cpu> order = cpus;
+	if (placement == PHYSICAL_CORES) {
+		order.erase(std::remove_if(order.begin(), order.end(), [](const Cpu& cpu) { return cpu.sibling != 0; }), order.end());
+	}
+	if (placement == SCATTER) {
+		// first hardware threads of every core before any second ones, node by node, then dealt out across the nodes
+		std::sort(order.begin(), order.end(), [](const Cpu& a, const Cpu& b) {
+			return std::tie(a.node, a.sibling, a.package, a.core) < std::tie(b.node, b.sibling, b.package, b.core);
+		});
+		std::vector<std::vector<Cpu>> byNode;
+		for (const Cpu& cpu : order) {
+			if (byNode.empty() || byNode.back().front().node != cpu.node) byNode.emplace_back();
+			byNode.back().push_back(cpu);
+		}
+		order.clear();
+		for (size_t rank = 0; order.size() < cpus.size(); rank++) {
+			for (const std::vector<Cpu>& node : byNode) if (rank < node.size()) order.push_back(node[rank]);
+		}
+	}
+	else {
+		std::sort(order.begin(), order.end(), [](const Cpu& a, const Cpu& b) {
+			return std::tie(a.node, a.package, a.core, a.sibling) < std::tie(b.node, b.package, b.core, b.sibling);
+		});
+	}
+
+	for (uint32_t i = 0; i < numThreads; i++) placed.push_back(order[i % order.size()].id);
+	return placed;
+}
+
+uint32_t CpuTopology::nodeOf(uint32_t cpu) const {
+	for (const Cpu& known : cpus) if (known.id == cpu) return known.node;
+	return 0;
+}
+
+bool CpuTopology::pinCurrentThread(uint32_t cpu) {
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (cpu == ANY_CPU) {
+		for (const Cpu& known : get().cpus) if (known.id < CPU_SETSIZE) CPU_SET(known.id, &set);
+	}
+	else if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+	else return false;
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+const char* CpuTopology::placementName(Placement placement) {
+	switch (placement) {
+	case COMPACT: return "compact";
+	case SCATTER: return "scatter";
+	case PHYSICAL_CORES: return "physical_cores";
+	default: return "unpinned";
+	}
+}
+
+bool CpuTopology::parsePlacement(const std::string& name, Placement& placement) {
+	for (Placement candidate : { UNPINNED, COMPACT, SCATTER, PHYSICAL_CORES }) {
+		if (name == placementName(candidate)) {
+			placement = candidate;
+			return true;
+		}
+	}
+	return false;
+}
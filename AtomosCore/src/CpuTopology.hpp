@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+
+// Which logical CPUs share a physical core, a package and a NUMA node, and where to put the threads of a
+// pool on them. On Linux the layout comes from sysfs; elsewhere, or if sysfs cannot be read, every CPU
+// reported by the standard library counts as its own core on a single node and pinning does nothing.
+class CpuTopology {
+public:
+	enum Placement {
+		UNPINNED,			// leave threads to the OS scheduler
+		COMPACT,			// fill the hardware threads of one core, then the cores of one node, before moving on
+		SCATTER,			// spread threads over the nodes first, then over the physical cores within each node
+		PHYSICAL_CORES		// one thread per physical core, node by node, never two on hyperthread siblings
+	};
+
+	struct Cpu {
+		uint32_t id;		// logical CPU number as the OS counts it
+		uint32_t core;		// core_id, only unique within a package
+		uint32_t package;
+		uint32_t node;
+		uint32_t sibling;	// 0 for the first hardware thread of its core, 1 for the second, ...
+	};
+
+	static constexpr uint32_t ANY_CPU = UINT32_MAX;
+
+	std::vector<Cpu> cpus;
+
+	// root is only there so the parser can be pointed at a copy of another machine's sysfs
+	static CpuTopology detect(const std::string& root = "/sys/devices/system");
+	static const CpuTopology& get();		// detected once, on first use
+
+	uint32_t numNodes() const;
+	uint32_t numCores() const;
+	// logical CPU for each of numThreads threads, empty for UNPINNED; threads wrap around once the policy runs out of CPUs
+	std::vector<uint32_t> place(Placement placement, uint32_t numThreads) const;
+	// node of a logical CPU, 0 if it is unknown
+	uint32_t nodeOf(uint32_t cpu) const;
+
+	// binds the calling thread to one logical CPU, or releases it to all of them for ANY_CPU;
+	// false where that is unsupported or refused
+	static bool pinCurrentThread(uint32_t cpu);
+	static const char* placementName(Placement placement);
+	// accepts the names placementName returns, false for anything else
+	static bool parsePlacement(const std::string& name, Placement& placement);
+};
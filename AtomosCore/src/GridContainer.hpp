@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glm.hpp>
+#include <stdint.h>
+#include <vector>
+#include <cassert>
+#include <concepts>
+
+
+template <typename T>
+concept Placeable = requires (T t) { t.position; };
+
+template<typename T>
+concept Boundable = requires (T t) { t.minimumBound; t.maximumBound; };
+
+template <Boundable NodeType>
+class GridContainer {
+protected:
+	static uint32_t nextID;
+	uint32_t width;
+	uint32_t height;
+	uint32_t nodeSize;
+	std::template vector<NodeType*> gridSquares; 
+
+public:
+	// cell indices are computed in size_t, a 65k x 65k grid already has more cells than uint32_t can count
+	NodeType* getCell(uint32_t x, uint32_t y) { return gridSquares.at(static_cast<size_t>(y) * width + x); }
+	NodeType* getCell(glm::uvec2 pos) { return getCell(pos.x, pos.y); };
+	NodeType* getCellFromPosition(float x, float y) { return getCell(getGridIndex({ x, y })); }
+	NodeType* getCellFromPosition(glm::vec2 pos) { return getCellFromPosition(pos.x, pos.y); }
+	uint32_t getWidth() const { return width; }
+	uint32_t getHeight() const { return height; }
+	uint32_t getNodeSize() const { return nodeSize; }
+	size_t getNumCells() const { return gridSquares.size(); }
+
+	GridContainer(uint32_t m, uint32_t n, uint32_t size) {
+		width = m;
+		height = n;
+		nodeSize = size;
+		
+		gridSquares.reserve(static_cast<size_t>(m) * n);
+		for (size_t i = 0; i < static_cast<size_t>(m) * n; i++) {
+			gridSquares.push_back(new NodeType(static_cast<uint32_t>(i % width), static_cast<uint32_t>(i / width), size));
+		}
+	}
+	~GridContainer() {	for (NodeType* v : gridSquares) delete v; }
+	// rebuilds the empty cells of columns [xLow, xHigh) on the calling thread so their memory is first touched,
+	// and placed, by that thread; anything linked into the old cells is dropped
+	void reallocateColumns(uint32_t xLow, uint32_t xHigh) {
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = xLow; x < xHigh; x++) {
+				NodeType*& cell = gridSquares[static_cast<size_t>(y) * width + x];
+				delete cell;
+				cell = new NodeType(x, y, nodeSize);
+			}
+		}
+	}
+	glm::uvec2 getGridIndex(glm::vec2 position) {
+		uint32_t x = static_cast<uint32_t>(floor(position.x / nodeSize));
+		uint32_t y = static_cast<uint32_t>(floor(position.y / nodeSize));
+		return glm::uvec2(x, y);
+	}
+	bool contains(glm::vec2 position) const {
+		return position.x >= 0 && position.y >= 0 && position.x < static_cast<float>(width) * nodeSize && position.y < static_cast<float>(height) * nodeSize;
+	}
+	template <Placeable NodeObject>bool insert(NodeObject* object) {
+		if (!contains(object->position)) return 0;
+		glm::uvec2 gridIndex = getGridIndex(object->position);
+		if (gridIndex.x >= width || gridIndex.y >= height) return 0;
+		
+		bool inserted = getCell(gridIndex)->insert(object);
+		assert(inserted);
+		return inserted;
+	}
+	// same as insert, for node types that can keep their objects sorted
+	template <Placeable NodeObject>bool insertSorted(NodeObject* object) {
+		if (!contains(object->position)) return 0;
+		glm::uvec2 gridIndex = getGridIndex(object->position);
+		if (gridIndex.x >= width || gridIndex.y >= height) return 0;
+
+		bool inserted = getCell(gridIndex)->insertSorted(object);
+		assert(inserted);
+		return inserted;
+	}
+	void clear() { for (NodeType* v : gridSquares) v->clear(); }
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "SharedFrameRing.hpp"
+
+#include <algorithm>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SHARED_FRAMES_SUPPORTED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+constexpr size_t RING_ALIGNMENT = 64;
+constexpr size_t BYTES_PER_OBJECT = 2 * sizeof(float) + 2 * sizeof(float) + sizeof(float) + sizeof(uint32_t) + sizeof(uint32_t);
+constexpr int READ_ATTEMPTS = 4;		// before readLatest gives up on a writer that keeps lapping it
+
+static size_t alignUp(size_t bytes) {
+	return (bytes + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+}
+
+
+SharedFrameRing::SharedFrameRing(const std::string& name_, void* memory_, size_t bytes_, bool owner_) :
+	name(name_), memory(memory_), bytes(bytes_), owner(owner_), header(static_cast<Header*>(memory_)) {}
+
+SharedFrameRing::~SharedFrameRing() {
+#ifdef SHARED_FRAMES_SUPPORTED
+	munmap(memory, bytes);
+	if (owner) shm_unlink(name.c_str());
+#endif
+}
+
+SharedFrameRing* SharedFrameRing::create(const std::string& name, uint32_t slotCount, uint32_t capacity) {
+#ifdef SHARED_FRAMES_SUPPORTED
+	if (slotCount == 0) return 0;
+	size_t slotBytes = alignUp(sizeof(Slot) + capacity * BYTES_PER_OBJECT);
+	size_t bytes = sizeof(Header) + slotCount * slotBytes;
+
+	shm_unlink(name.c_str());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) return 0;
+	if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+		close(fd);
+		shm_unlink(name.c_str());
+		return 0;
+	}
+	void* memory = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		return 0;
+	}
+
+	// the object comes zeroed, so every slot starts out complete, empty and at sequence 0
+	Header* header = new (memory) Header();
+	header->version = VERSION;
+	header->slotCount = slotCount;
+	header->capacity = capacity;
+	header->slotBytes = slotBytes;
+	header->latest.store(0, std::memory_order_relaxed);
+	for (uint32_t i = 0; i < slotCount; i++) new (static_cast<char*>(memory) + sizeof(Header) + i * slotBytes) Slot();
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = MAGIC;
+	return new SharedFrameRing(name, memory, bytes, true);
+#else
+	return 0;
+#endif
+}
+
+SharedFrameRing* SharedFrameRing::open(const std::string& name) {
+#ifdef SHARED_FRAMES_SUPPORTED
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0) return 0;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+		close(fd);
+		return 0;
+	}
+	size_t bytes = static_cast<size_t>(info.st_size);
+	void* memory = mmap(0, bytes, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) return 0;
+
+	const Header* header = static_cast<const Header*>(memory);
+	bool valid = header->magic == MAGIC && header->version == VERSION && header->slotCount > 0 &&
+		header->slotBytes >= sizeof(Slot) + header->capacity * BYTES_PER_OBJECT &&
+		sizeof(Header) + header->slotCount * header->slotBytes <= bytes;
+	if (!valid) {
+		munmap(memory, bytes);
+		return 0;
+	}
+	return new SharedFrameRing(name, memory, bytes, false);
+#else
+	return 0;
+#endif
+}
+
+SharedFrameRing::Slot* SharedFrameRing::getSlot(uint64_t frame) const {
+	char* slots = static_cast<char*>(memory) + sizeof(Header);
+	return reinterpret_cast<Slot*>(slots + (frame % header->slotCount) * header->slotBytes);
+}
+
+SharedFrameRing::Arrays SharedFrameRing::getArrays(Slot* slot) const {
+	char* data = reinterpret_cast<char*>(slot) + sizeof(Slot);
+	size_t capacity = header->capacity;
+	Arrays arrays;
+	arrays.positions = reinterpret_cast<float*>(data);
+	arrays.velocities = arrays.positions + 2 * capacity;
+	arrays.radii = arrays.velocities + 2 * capacity;
+	arrays.colors = reinterpret_cast<uint32_t*>(arrays.radii + capacity);
+	arrays.ids = arrays.colors + capacity;
+	return arrays;
+}
+
+SharedFrameRing::Arrays SharedFrameRing::beginWrite(uint64_t frame) {
+	writing = getSlot(frame);
+	writing->sequence.store(writing->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	writing->frame = frame;
+	return getArrays(writing);
+}
+
+void SharedFrameRing::endWrite(uint32_t count, uint32_t total) {
+	writing->count = std::min(count, header->capacity);
+	writing->total = total;
+	writing->sequence.store(writing->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	header->latest.store(writing->frame, std::memory_order_release);
+	writing = 0;
+}
+
+bool SharedFrameRing::readLatest(Frame& frame) const {
+	for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+		uint64_t latest = header->latest.load(std::memory_order_acquire);
+		if (latest == 0 || latest <= frame.frame) return false;
+
+		Slot* slot = getSlot(latest);
+		uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if (sequence & 1) continue;
+
+		uint64_t slotFrame = slot->frame;
+		uint32_t total = slot->total;
+		uint32_t count = std::min(slot->count, header->capacity);
+		Arrays arrays = getArrays(slot);
+		frame.positions.assign(arrays.positions, arrays.positions + 2 * count);
+		frame.velocities.assign(arrays.velocities, arrays.velocities + 2 * count);
+		frame.radii.assign(arrays.radii, arrays.radii + count);
+		frame.colors.assign(arrays.colors, arrays.colors + count);
+		frame.ids.assign(arrays.ids, arrays.ids + count);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot->sequence.load(std::memory_order_relaxed) != sequence || slotFrame != latest) continue;
+		frame.frame = slotFrame;
+		frame.total = total;
+		return true;
+	}
+	return false;
+}
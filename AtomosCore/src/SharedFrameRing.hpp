@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+// Frames of particle arrays in a POSIX shared memory object, written by the simulation and read by other
+// local processes that map the same name. The memory holds a Header and then slotCount slots of
+// slotBytes each: a Slot followed by the arrays of one frame, positions and velocities as x, y pairs,
+// then radii, colours and ids, each capacity entries long, so a reader can use them in place.
+// The writer fills slot frame % slotCount under a seqlock: the slot's sequence is odd while it writes
+// and even once the frame is complete, after which latest names the frame. It never waits on a reader;
+// a reader that finds the sequence odd, or changed once it is done, has to read again.
+// Only POSIX systems have shared memory objects, elsewhere create and open return 0.
+class SharedFrameRing {
+public:
+	static constexpr uint32_t MAGIC = 0x41544f4d;		// "ATOM"
+	static constexpr uint32_t VERSION = 1;
+
+	struct alignas(64) Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t slotCount;
+		uint32_t capacity;				// objects per slot, larger frames are cut off
+		uint64_t slotBytes;
+		std::atomic<uint64_t> latest;	// newest complete frame, 0 before the first
+	};
+
+	struct alignas(64) Slot {
+		std::atomic<uint64_t> sequence;
+		uint64_t frame;
+		uint32_t count;					// objects in the arrays
+		uint32_t total;					// objects in the world, more than count when the frame was cut off
+	};
+
+	// one slot's arrays, capacity entries each
+	struct Arrays {
+		float* positions;
+		float* velocities;
+		float* radii;
+		uint32_t* colors;
+		uint32_t* ids;
+	};
+
+	// a frame copied out by readLatest
+	struct Frame {
+		uint64_t frame = 0;
+		uint32_t total = 0;
+		std::vector<float> positions;
+		std::vector<float> velocities;
+		std::vector<float> radii;
+		std::vector<uint32_t> colors;
+		std::vector<uint32_t> ids;
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock is shared between processes");
+
+	// name is a shared memory name such as "/atomos"; create replaces any object of that name and removes
+	// it again when the ring is deleted, open maps an existing one read only
+	static SharedFrameRing* create(const std::string& name, uint32_t slotCount, uint32_t capacity);
+	static SharedFrameRing* open(const std::string& name);
+	~SharedFrameRing();
+
+	const Header& getHeader() const { return *header; }
+	const std::string& getName() const { return name; }
+
+	// writer only: fills the arrays beginWrite hands out with count objects, then calls endWrite
+	Arrays beginWrite(uint64_t frame);
+	void endWrite(uint32_t count, uint32_t total);
+
+	// copies the newest frame newer than frame.frame into frame, false if there is none or the writer kept
+	// overwriting it, in which case the arrays of frame may hold parts of a torn copy
+	bool readLatest(Frame& frame) const;
+
+private:
+	SharedFrameRing(const std::string& name, void* memory, size_t bytes, bool owner);
+	Slot* getSlot(uint64_t frame) const;
+	Arrays getArrays(Slot* slot) const;
+
+	std::string name;
+	void* memory;
+	size_t bytes;
+	bool owner;
+	Header* header;
+	Slot* writing = 0;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <glm.hpp>
+#include <stdint.h>
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include "GridContainer.hpp"
+
+
+// Sparse counterpart to GridContainer. Only cells that hold something exist: their coordinates are kept
+// in an open-addressing table (linear probing, power of two capacity) that points into a compact list of
+// nodes, so memory and iteration are proportional to the occupied cells rather than the world area.
+// Coordinates are signed and unbounded; nodes left of or above the origin get wrapped bounds, which
+// nothing that walks the hash reads.
+template <Boundable NodeType>
+class SpatialHash {
+	static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+	static constexpr size_t MINIMUM_CAPACITY = 64;
+
+	struct Slot {
+		glm::ivec2 key;
+		uint32_t node = EMPTY_SLOT;
+	};
+
+protected:
+	uint32_t nodeSize;
+	std::vector<Slot> table;
+	std::vector<glm::ivec2> occupiedKeys;
+	std::vector<size_t> occupiedSlots;
+	std::vector<NodeType*> nodes;	// the first occupiedKeys.size() are in use, the rest are kept for reuse
+
+	static size_t hash(glm::ivec2 key) {
+		uint32_t h = static_cast<uint32_t>(key.x) * 73856093u ^ static_cast<uint32_t>(key.y) * 19349663u;
+		h ^= h >> 16;
+		h *= 0x45d9f3bu;
+		h ^= h >> 16;
+		return h;
+	}
+
+	size_t findSlot(glm::ivec2 key) const {
+		size_t mask = table.size() - 1;
+		size_t i = hash(key) & mask;
+		while (table[i].node != EMPTY_SLOT && table[i].key != key) i = (i + 1) & mask;
+		return i;
+	}
+
+	// keeps the load factor under one half
+	void grow() {
+		std::vector<Slot> old;
+		old.swap(table);
+		table.resize(old.size() * 2);
+		for (const Slot& slot : old) {
+			if (slot.node == EMPTY_SLOT) continue;
+			size_t i = findSlot(slot.key);
+			table[i] = slot;
+			occupiedSlots[slot.node] = i;
+		}
+	}
+
+	NodeType* createCell(size_t slot, glm::ivec2 key) {
+		uint32_t n = static_cast<uint32_t>(occupiedKeys.size());
+		if (n < nodes.size()) *nodes[n] = NodeType(key.x, key.y, nodeSize);
+		else nodes.push_back(new NodeType(key.x, key.y, nodeSize));
+		occupiedKeys.push_back(key);
+		occupiedSlots.push_back(slot);
+		table[slot] = { key, n };
+
+		if (occupiedKeys.size() * 2 > table.size()) grow();
+		return nodes[n];
+	}
+
+public:
+	NodeType* getCell(glm::ivec2 key) {
+		const Slot& slot = table[findSlot(key)];
+		return slot.node == EMPTY_SLOT ? nullptr : nodes[slot.node];
+	}
+	NodeType* getCell(int32_t x, int32_t y) { return getCell({ x, y }); }
+	NodeType* getCellFromPosition(float x, float y) { return getCell(getGridIndex({ x, y })); }
+	NodeType* getCellFromPosition(glm::vec2 pos) { return getCellFromPosition(pos.x, pos.y); }
+	// occupied cells are numbered 0..getNumCells()-1 in the order they were filled
+	NodeType* getOccupiedCell(size_t n) { return nodes[n]; }
+	glm::ivec2 getOccupiedIndex(size_t n) const { return occupiedKeys[n]; }
+	uint32_t getNodeSize() const { return nodeSize; }
+	size_t getNumCells() const { return occupiedKeys.size(); }
+
+	SpatialHash(uint32_t size, size_t expectedCells = MINIMUM_CAPACITY) {
+		nodeSize = size;
+
+		size_t capacity = MINIMUM_CAPACITY;
+		while (capacity < expectedCells * 2) capacity *= 2;
+		table.resize(capacity);
+	}
+	~SpatialHash() { for (NodeType* v : nodes) delete v; }
+	glm::ivec2 getGridIndex(glm::vec2 position) {
+		int32_t x = static_cast<int32_t>(floor(position.x / nodeSize));
+		int32_t y = static_cast<int32_t>(floor(position.y / nodeSize));
+		return glm::ivec2(x, y);
+	}
+	template <Placeable NodeObject> bool insert(NodeObject* object) {
+		glm::ivec2 gridIndex = getGridIndex(object->position);
+		size_t slot = findSlot(gridIndex);
+		NodeType* cell = table[slot].node == EMPTY_SLOT ? createCell(slot, gridIndex) : nodes[table[slot].node];
+
+		bool inserted = cell->insert(object);
+		assert(inserted);
+		return inserted;
+	}
+	// only touches the cells that were occupied, the nodes stay allocated for the next fill
+	void clear() {
+		for (size_t n = 0; n < occupiedKeys.size(); n++) {
+			nodes[n]->clear();
+			table[occupiedSlots[n]].node = EMPTY_SLOT;
+		}
+		occupiedKeys.clear();
+		occupiedSlots.clear();
+	}
+};
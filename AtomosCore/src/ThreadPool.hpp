@@ -0,0 +1,192 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include "Tracer.hpp"
+#include "CpuTopology.hpp"
+
+
+class ThreadPool {
+	static constexpr uint32_t ANY_WORKER = UINT32_MAX;
+
+	std::vector<std::thread> threads;
+	std::queue<std::function<void()>> taskQueue;
+	std::vector<std::queue<std::function<void()>>> workerQueues;		// tasks only worker i may run
+	CpuTopology::Placement placement = CpuTopology::UNPINNED;
+	std::vector<uint32_t> workerNodes;
+
+	mutable std::mutex mutex;
+	std::condition_variable cv;
+
+	bool shutdownRequested = false;
+	int workingThreads;
+
+	std::atomic<uint64_t> tasksCompleted = 0;
+	std::atomic<uint64_t> waitNanos = 0;
+	std::atomic<uint64_t> busyNanos = 0;
+
+	struct TaskTimer {
+		ThreadPool* pool;
+		std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+
+		TaskTimer(ThreadPool* pool_, std::chrono::steady_clock::time_point queuedAt) : pool(pool_) {
+			pool->waitNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(startedAt - queuedAt).count(), std::memory_order_relaxed);
+		}
+		~TaskTimer() {
+			auto finishedAt = std::chrono::steady_clock::now();
+			pool->busyNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(finishedAt - startedAt).count(), std::memory_order_relaxed);
+			pool->tasksCompleted.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	struct WorkerThread {
+		ThreadPool* pool;
+		uint32_t index;
+
+		WorkerThread(ThreadPool* pool_, uint32_t index_) : pool(pool_), index(index_) {}
+		void operator()() {
+			Tracer::setThreadName("pool worker");
+
+			// take mutex
+			std::unique_lock<std::mutex> lock(pool->mutex);
+			std::queue<std::function<void()>>& ownQueue = pool->workerQueues[index];
+
+			while (!pool->shutdownRequested || !pool->taskQueue.empty() || !ownQueue.empty()) {
+				// wait on the condition variable until woken up
+				pool->workingThreads--;
+				{
+					Tracer::Scope idle("wait");
+					pool->cv.wait(lock, [this, &ownQueue] {
+						return this->pool->shutdownRequested || !this->pool->taskQueue.empty() || !ownQueue.empty();
+						});
+				}
+				pool->workingThreads++;
+
+				// take a task and perform the function, tasks meant for this worker first since no one else can run them
+				std::queue<std::function<void()>>& queue = !ownQueue.empty() ? ownQueue : pool->taskQueue;
+				if (!queue.empty()) {
+					auto func = queue.front();
+					queue.pop();
+
+					lock.unlock();
+					func();
+					lock.lock();
+				}
+			}
+		}
+	};
+
+public:
+	// running totals since the pool was made, callers diff two reads to get a window
+	struct Stats {
+		uint64_t tasksCompleted;
+		uint64_t waitNanos;		// time tasks sat in the queue before a thread took them
+		uint64_t busyNanos;		// time threads spent running tasks
+	};
+
+	// make the threads, their queues have to exist before the first one starts
+	ThreadPool(const uint32_t numThreads) : workerQueues(numThreads), workerNodes(numThreads, 0), workingThreads(numThreads) {
+		for (uint32_t i = 0; i < numThreads; i++) {
+			threads.push_back(std::thread(WorkerThread(this, i)));
+		}
+	}
+
+	~ThreadPool() {
+		// wake all threads to join them all
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			shutdownRequested = true;
+			cv.notify_all();
+		}
+
+		// join the threads
+		for (int i = 0; i < threads.size(); i++) {
+			if (threads[i].joinable()) {
+				threads[i].join();
+			}
+		}
+	}
+
+	// wrap a function and its arguments, any worker may run it
+	template <typename F, typename... Args>
+	auto addTask(F&& function, Args&&... arguments) -> std::future<decltype(function(arguments...))> {
+		return enqueue(ANY_WORKER, std::forward<F>(function), std::forward<Args>(arguments)...);
+	}
+
+	// same as addTask, but only worker % size() runs it, so work split the same way every frame stays on
+	// the same thread and, once the pool is pinned, on the same core and NUMA node
+	template <typename F, typename... Args>
+	auto addTaskTo(uint32_t worker, F&& function, Args&&... arguments) -> std::future<decltype(function(arguments...))> {
+		return enqueue(worker % static_cast<uint32_t>(threads.size()), std::forward<F>(function), std::forward<Args>(arguments)...);
+	}
+
+	// Moves every worker onto the CPUs placement picks for it and waits until they are there. Returns
+	// false if any worker could not be pinned, in which case it keeps running wherever the OS puts it.
+	bool pin(CpuTopology::Placement placement_) {
+		const CpuTopology& topology = CpuTopology::get();
+		std::vector<uint32_t> cpus = topology.place(placement_, static_cast<uint32_t>(threads.size()));
+		std::vector<std::future<bool>> pinned;
+		for (uint32_t i = 0; i < threads.size(); i++) {
+			uint32_t cpu = cpus.empty() ? CpuTopology::ANY_CPU : cpus[i];
+			workerNodes[i] = cpus.empty() ? 0 : topology.nodeOf(cpu);
+			pinned.push_back(addTaskTo(i, [cpu]() { return CpuTopology::pinCurrentThread(cpu); }));
+		}
+		bool allPinned = true;
+		for (auto& result : pinned) allPinned &= result.get();
+		placement = placement_;
+		return allPinned;
+	}
+
+	CpuTopology::Placement getPlacement() const { return placement; }
+	// node the worker was pinned to, 0 while unpinned
+	uint32_t getWorkerNode(uint32_t worker) const { return workerNodes[worker % workerNodes.size()]; }
+	size_t size() const { return threads.size(); }
+
+	Stats getStats() const {
+		return { tasksCompleted.load(std::memory_order_relaxed), waitNanos.load(std::memory_order_relaxed), busyNanos.load(std::memory_order_relaxed) };
+	}
+
+private:
+	template <typename F, typename... Args>
+	auto enqueue(uint32_t worker, F&& function, Args&&... arguments) -> std::future<decltype(function(arguments...))> {
+		// bind function and arguments together before packing
+		auto boundFunction = std::bind(std::forward<F>(function), std::forward<Args>(arguments)...);
+
+		// time how long the task waited and ran, the counters are updated before its future becomes ready
+		auto queuedAt = std::chrono::steady_clock::now();
+		auto timedFunction = [this, boundFunction, queuedAt]() mutable {
+			TaskTimer taskTimer(this, queuedAt);
+			Tracer::Scope taskScope("task");
+			return boundFunction();
+		};
+
+		// build a packaged_task as a shared resource for the threads
+		auto sharedTask = std::make_shared<std::packaged_task<decltype(function(arguments...))()>>(timedFunction);
+
+		// lambda wrapper function to place the task in the queue
+		auto wrapperLambda = [sharedTask]() { (*sharedTask)(); };
+
+		// grab the mutex before queue operations		
+		// scoped to force a call to the lock's destructor.
+		// A task for one worker wakes everyone, notify_one could pick a thread that has to go back to sleep
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (worker == ANY_WORKER) {
+				taskQueue.push(wrapperLambda);
+				cv.notify_one();
+			}
+			else {
+				workerQueues[worker].push(wrapperLambda);
+				cv.notify_all();
+			}
+		}
+
+		return sharedTask->get_future();
+	}
+};
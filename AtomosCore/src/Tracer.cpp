@@ -0,0 +1,151 @@
+#include "Tracer.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cinttypes>
+
+
+std::atomic<bool> Tracer::isRecording = false;
+std::atomic<bool> Tracer::capturePending = false;
+
+namespace {
+	// owned by the registry rather than the thread, so a thread may exit before its events are written
+	struct ThreadBuffer {
+		uint32_t threadID;
+		std::string name;
+		std::unique_ptr<Tracer::Event[]> events{ new Tracer::Event[Tracer::EVENTS_PER_THREAD] };
+		std::atomic<uint64_t> count = 0;	// only the owning thread stores to this
+		uint64_t captureStart = 0;			// count when the current capture began, simulation thread only
+	};
+
+	std::mutex registryMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+	// capture request and state, the request is guarded by registryMutex
+	std::string requestedPath;
+	uint32_t requestedFrames = 0;
+	std::string capturePath;
+	uint32_t framesRemaining = 0;
+	int64_t captureOrigin = 0;
+	int64_t frameBegin = 0;
+
+	thread_local const char* threadName = nullptr;
+	thread_local ThreadBuffer* threadBuffer = nullptr;
+
+	ThreadBuffer* getThreadBuffer() {
+		if (threadBuffer) return threadBuffer;
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+		registry.push_back(std::make_unique<ThreadBuffer>());
+		threadBuffer = registry.back().get();
+		threadBuffer->threadID = static_cast<uint32_t>(registry.size());
+		threadBuffer->name = threadName ? threadName : "thread " + std::to_string(threadBuffer->threadID);
+		return threadBuffer;
+	}
+
+	// chrome traces count in microseconds
+	void writeMicros(std::ofstream& file, int64_t nanos) {
+		char text[32];
+		std::snprintf(text, sizeof(text), "%" PRId64 ".%03d", nanos / 1000, static_cast<int>(nanos % 1000));
+		file << text;
+	}
+}
+
+
+int64_t Tracer::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::record(const char* name, int64_t beginNanos, int64_t endNanos) {
+	if (!recording()) return;
+
+	ThreadBuffer* buffer = getThreadBuffer();
+	uint64_t count = buffer->count.load(std::memory_order_relaxed);
+	buffer->events[count % EVENTS_PER_THREAD] = { name, beginNanos, endNanos };
+	buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const char* name) {
+	threadName = name;
+	if (threadBuffer) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		threadBuffer->name = name;
+	}
+}
+
+void Tracer::capture(const std::string& path, uint32_t frames) {
+	if (frames == 0) return;
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	requestedPath = path;
+	requestedFrames = frames;
+	capturePending.store(true, std::memory_order_release);
+}
+
+bool Tracer::capturing() {
+	return recording() || capturePending.load(std::memory_order_relaxed);
+}
+
+void Tracer::beginFrame() {
+	if (!recording() && capturePending.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		capturePath = requestedPath;
+		framesRemaining = requestedFrames;
+		capturePending.store(false, std::memory_order_relaxed);
+
+		// events left over from earlier captures stay in the buffers but are skipped
+		for (auto& buffer : registry) buffer->captureStart = buffer->count.load(std::memory_order_acquire);
+		captureOrigin = now();
+		isRecording.store(true, std::memory_order_release);
+	}
+
+	frameBegin = now();
+}
+
+void Tracer::endFrame() {
+	if (!recording()) return;
+
+	record("frame", frameBegin, now());
+	if (--framesRemaining > 0) return;
+
+	isRecording.store(false, std::memory_order_release);
+	writeCapture();
+}
+
+// Threads that were inside a scope as recording stopped may still add one event, it lands past the count
+// read here and is skipped by the next capture.
+void Tracer::writeCapture() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	std::ofstream file(capturePath);
+	if (!file) return;
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (auto& buffer : registry) {
+		uint64_t end = buffer->count.load(std::memory_order_acquire);
+		uint64_t begin = buffer->captureStart;
+		if (end - begin > EVENTS_PER_THREAD) begin = end - EVENTS_PER_THREAD;
+		if (begin == end) continue;
+
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadID
+			<< ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+		first = false;
+
+		for (uint64_t i = begin; i < end; i++) {
+			const Event& event = buffer->events[i % EVENTS_PER_THREAD];
+			if (event.beginNanos < captureOrigin) continue;
+
+			file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"atomos\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadID << ",\"ts\":";
+			writeMicros(file, event.beginNanos - captureOrigin);
+			file << ",\"dur\":";
+			writeMicros(file, event.endNanos - event.beginNanos);
+			file << "}";
+		}
+	}
+	file << "\n]}\n";
+}
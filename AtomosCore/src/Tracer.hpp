@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+
+// Records when tasks and engine stages begin and end over a window of frames and writes the result as a
+// Chrome trace-event file, which opens in Perfetto or chrome://tracing.
+// Every thread appends to a buffer of its own so recording never takes a lock, and the buffers are only
+// read once recording has stopped. While nothing is being captured a scope costs one relaxed load.
+class Tracer {
+public:
+	static constexpr size_t EVENTS_PER_THREAD = 1 << 16;	// older events are overwritten once a capture outgrows this
+
+	struct Event {
+		const char* name;	// must outlive the capture, string literals in practice
+		int64_t beginNanos;
+		int64_t endNanos;
+	};
+
+	// records the lifetime of the enclosing block as one event, if a capture was running when it began
+	class Scope {
+		const char* name;
+		int64_t beginNanos;
+
+	public:
+		Scope(const char* name_) : name(name_), beginNanos(recording() ? now() : -1) {}
+		~Scope() { if (beginNanos >= 0) record(name, beginNanos, now()); }
+	};
+
+	static bool recording() { return isRecording.load(std::memory_order_relaxed); }
+	static int64_t now();
+	static void record(const char* name, int64_t beginNanos, int64_t endNanos);
+
+	// label for the calling thread in the timeline
+	static void setThreadName(const char* name);
+
+	// safe from any thread, recording starts with the next frame and the file is written after the last
+	static void capture(const std::string& path, uint32_t frames);
+	static bool capturing();
+
+	// called by the simulation thread around every frame
+	static void beginFrame();
+	static void endFrame();
+
+private:
+	static std::atomic<bool> isRecording;
+	static std::atomic<bool> capturePending;
+
+	static void writeCapture();
+};
@@ -0,0 +1,336 @@
+#include "TrajectoryRecorder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+constexpr size_t FILE_HEADER_BYTES = 16;
+constexpr size_t CHUNK_HEADER_BYTES = 16;
+constexpr size_t INDEX_ENTRY_BYTES = 20;
+constexpr size_t FOOTER_BYTES = 24;
+
+enum FrameKind : uint8_t { KEYFRAME, DELTA_FRAME };
+
+
+namespace {
+	void putU32(std::vector<uint8_t>& out, uint32_t value) {
+		for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+
+	void putU64(std::vector<uint8_t>& out, uint64_t value) {
+		for (int i = 0; i < 8; i++) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+
+	uint32_t getU32(const uint8_t* in) {
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+		return value;
+	}
+
+	uint64_t getU64(const uint8_t* in) {
+		uint64_t value = 0;
+		for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+		return value;
+	}
+
+	// seven bits a byte, low bits first, the top bit set on every byte but the last
+	void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+		while (value >= 0x80) {
+			out.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<uint8_t>(value));
+	}
+
+	// small magnitudes of either sign become small varints: 0, -1, 1, -2, ... map to 0, 1, 2, 3, ...
+	void putSigned(std::vector<uint8_t>& out, int64_t value) {
+		putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+	}
+
+	bool getVarint(const std::vector<uint8_t>& in, size_t& cursor, uint64_t& value) {
+		value = 0;
+		for (int shift = 0; shift < 64 && cursor < in.size(); shift += 7) {
+			uint8_t byte = in[cursor++];
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) return true;
+		}
+		return false;
+	}
+
+	bool getSigned(const std::vector<uint8_t>& in, size_t& cursor, int64_t& value) {
+		uint64_t zigzag;
+		if (!getVarint(in, cursor, zigzag)) return false;
+		value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+		return true;
+	}
+
+	bool readBytes(std::ifstream& file, uint64_t offset, size_t count, std::vector<uint8_t>& out) {
+		out.resize(count);
+		file.clear();
+		file.seekg(static_cast<std::streamoff>(offset));
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(count)));
+	}
+}
+
+
+TrajectoryRecorder::TrajectoryRecorder(const std::string& path, float quantum_, uint32_t keyframeInterval_) :
+	file(path, std::ios::binary | std::ios::trunc), quantum(quantum_), keyframeInterval(std::max(1u, keyframeInterval_)) {
+	for (size_t i = 0; i < MAX_PENDING_FRAMES; i++) spare.push_back(new TrajectoryFrame());
+}
+
+TrajectoryRecorder* TrajectoryRecorder::create(const std::string& path, float quantum, uint32_t keyframeInterval) {
+	if (!(quantum > 0.f)) return 0;
+	TrajectoryRecorder* recorder = new TrajectoryRecorder(path, quantum, keyframeInterval);
+	if (!recorder->file) {
+		delete recorder;
+		return 0;
+	}
+
+	std::vector<uint8_t> header;
+	uint32_t quantumBits;
+	std::memcpy(&quantumBits, &quantum, sizeof(quantumBits));
+	putU32(header, MAGIC);
+	putU32(header, VERSION);
+	putU32(header, quantumBits);
+	putU32(header, recorder->keyframeInterval);
+	recorder->file.write(reinterpret_cast<const char*>(header.data()), header.size());
+	recorder->offset = FILE_HEADER_BYTES;
+
+	recorder->thread = std::thread(&TrajectoryRecorder::run, recorder);
+	return recorder;
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+	if (thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		frameQueued.notify_one();
+		thread.join();
+	}
+	for (TrajectoryFrame* frame : spare) delete frame;
+	delete filling;
+}
+
+TrajectoryFrame& TrajectoryRecorder::beginFrame() {
+	std::unique_lock<std::mutex> lock(mutex);
+	frameFreed.wait(lock, [this] { return !spare.empty(); });
+	filling = spare.back();
+	spare.pop_back();
+	return *filling;
+}
+
+void TrajectoryRecorder::endFrame() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.push_back(filling);
+		filling = 0;
+	}
+	frameQueued.notify_one();
+}
+
+TrajectoryRecorder::Stats TrajectoryRecorder::getStats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+void TrajectoryRecorder::run() {
+	for (;;) {
+		TrajectoryFrame* frame;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			frameQueued.wait(lock, [this] { return stopping || !pending.empty(); });
+			if (pending.empty()) break;
+			frame = pending.front();
+			pending.pop_front();
+		}
+		encode(*frame);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stats.frames++;
+			stats.rawBytes += frame->ids.size() * sizeof(uint32_t) + frame->positions.size() * sizeof(glm::vec2);
+			spare.push_back(frame);
+		}
+		frameFreed.notify_one();
+	}
+	flushChunk();
+	writeIndex();
+	file.close();
+}
+
+void TrajectoryRecorder::encode(const TrajectoryFrame& frame) {
+	if (chunkFrames == keyframeInterval) flushChunk();
+	if (chunkFrames == 0) chunkFirstFrame = frame.frame;
+
+	size_t count = std::min(frame.ids.size(), frame.positions.size());
+	currentPositions.resize(2 * count);
+	for (size_t i = 0; i < count; i++) {
+		currentPositions[2 * i] = static_cast<int32_t>(std::lround(frame.positions[i].x / quantum));
+		currentPositions[2 * i + 1] = static_cast<int32_t>(std::lround(frame.positions[i].y / quantum));
+	}
+
+	bool key = chunkFrames == 0 || count != previousIds.size() || !std::equal(previousIds.begin(), previousIds.end(), frame.ids.begin());
+	putVarint(chunk, frame.frame - chunkFirstFrame);
+	chunk.push_back(key ? KEYFRAME : DELTA_FRAME);
+	putVarint(chunk, count);
+	if (key) {
+		int64_t previousId = 0;
+		for (size_t i = 0; i < count; i++) {
+			putSigned(chunk, static_cast<int64_t>(frame.ids[i]) - previousId);
+			previousId = frame.ids[i];
+		}
+		for (int32_t position : currentPositions) putSigned(chunk, position);
+		previousIds.assign(frame.ids.begin(), frame.ids.begin() + count);
+	}
+	else {
+		for (size_t i = 0; i < 2 * count; i++) putSigned(chunk, static_cast<int64_t>(currentPositions[i]) - previousPositions[i]);
+	}
+	previousPositions.swap(currentPositions);
+	lastFrame = frame.frame;
+	chunkFrames++;
+}
+
+void TrajectoryRecorder::flushChunk() {
+	if (chunkFrames == 0) return;
+	std::vector<uint8_t> header;
+	putU64(header, chunkFirstFrame);
+	putU32(header, chunkFrames);
+	putU32(header, static_cast<uint32_t>(chunk.size()));
+	file.write(reinterpret_cast<const char*>(header.data()), header.size());
+	file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+
+	index.push_back({ chunkFirstFrame, offset, chunkFrames });
+	offset += CHUNK_HEADER_BYTES + chunk.size();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.chunks++;
+		stats.writtenBytes = offset;
+	}
+	chunk.clear();
+	chunkFrames = 0;
+}
+
+void TrajectoryRecorder::writeIndex() {
+	std::vector<uint8_t> tail;
+	for (const ChunkEntry& entry : index) {
+		putU64(tail, entry.firstFrame);
+		putU64(tail, entry.offset);
+		putU32(tail, entry.frameCount);
+	}
+	putU64(tail, lastFrame);
+	putU64(tail, offset);
+	putU32(tail, static_cast<uint32_t>(index.size()));
+	putU32(tail, MAGIC);
+	file.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	stats.writtenBytes = offset + tail.size();
+}
+
+
+TrajectoryReader* TrajectoryReader::open(const std::string& path) {
+	TrajectoryReader* reader = new TrajectoryReader();
+	std::ifstream& file = reader->file;
+	file.open(path, std::ios::binary);
+	std::vector<uint8_t> bytes;
+	bool valid = file && readBytes(file, 0, FILE_HEADER_BYTES, bytes) &&
+		getU32(bytes.data()) == TrajectoryRecorder::MAGIC && getU32(bytes.data() + 4) == TrajectoryRecorder::VERSION;
+	if (valid) {
+		uint32_t quantumBits = getU32(bytes.data() + 8);
+		std::memcpy(&reader->quantum, &quantumBits, sizeof(quantumBits));
+		file.seekg(0, std::ios::end);
+		uint64_t size = static_cast<uint64_t>(file.tellg());
+		valid = size >= FILE_HEADER_BYTES + FOOTER_BYTES && readBytes(file, size - FOOTER_BYTES, FOOTER_BYTES, bytes) &&
+			getU32(bytes.data() + 20) == TrajectoryRecorder::MAGIC;
+		if (valid) {
+			reader->lastFrame = getU64(bytes.data());
+			uint64_t indexOffset = getU64(bytes.data() + 8);
+			uint32_t chunkCount = getU32(bytes.data() + 16);
+			valid = indexOffset + static_cast<uint64_t>(chunkCount) * INDEX_ENTRY_BYTES + FOOTER_BYTES == size &&
+				readBytes(file, indexOffset, chunkCount * INDEX_ENTRY_BYTES, bytes);
+			for (uint32_t i = 0; valid && i < chunkCount; i++) {
+				const uint8_t* entry = bytes.data() + i * INDEX_ENTRY_BYTES;
+				reader->index.push_back({ getU64(entry), getU64(entry + 8), getU32(entry + 16) });
+			}
+		}
+	}
+	if (!valid) {
+		delete reader;
+		return 0;
+	}
+	return reader;
+}
+
+uint64_t TrajectoryReader::getFirstFrame() const {
+	return index.empty() ? 0 : index.front().firstFrame;
+}
+
+uint64_t TrajectoryReader::getLastFrame() const {
+	return lastFrame;
+}
+
+bool TrajectoryReader::readFrame(uint64_t frame, TrajectoryFrame& out) {
+	auto after = std::upper_bound(index.begin(), index.end(), frame, [](uint64_t frame, const ChunkEntry& entry) { return frame < entry.firstFrame; });
+	if (after == index.begin() || frame > lastFrame) return false;
+	size_t wanted = static_cast<size_t>(after - index.begin()) - 1;
+
+	// a chunk already decoded past frame has to start over from its keyframe
+	if (wanted != loadedChunk || (framesDecoded > 0 && currentFrame > frame)) {
+		const ChunkEntry& entry = index[wanted];
+		loadedChunk = SIZE_MAX;
+		if (!readBytes(file, entry.offset, CHUNK_HEADER_BYTES, chunk)) return false;
+		if (getU64(chunk.data()) != entry.firstFrame) return false;
+		if (!readBytes(file, entry.offset + CHUNK_HEADER_BYTES, getU32(chunk.data() + 12), chunk)) return false;
+		loadedChunk = wanted;
+		cursor = 0;
+		framesDecoded = 0;
+	}
+	while (framesDecoded == 0 || currentFrame < frame) {
+		if (framesDecoded == index[loadedChunk].frameCount || !decodeNext()) return false;
+	}
+	if (currentFrame != frame) return false;
+
+	out.frame = frame;
+	out.ids = ids;
+	out.positions.resize(ids.size());
+	for (size_t i = 0; i < ids.size(); i++) out.positions[i] = glm::vec2(positions[2 * i], positions[2 * i + 1]) * quantum;
+	return true;
+}
+
+bool TrajectoryReader::decodeNext() {
+	uint64_t frameOffset;
+	uint64_t count;
+	if (!getVarint(chunk, cursor, frameOffset) || cursor >= chunk.size()) return false;
+	uint8_t kind = chunk[cursor++];
+	if (!getVarint(chunk, cursor, count) || count > chunk.size()) return false;
+
+	if (kind == KEYFRAME) {
+		ids.resize(count);
+		positions.resize(2 * count);
+		int64_t id = 0;
+		for (size_t i = 0; i < count; i++) {
+			int64_t step;
+			if (!getSigned(chunk, cursor, step)) return false;
+			id += step;
+			ids[i] = static_cast<uint32_t>(id);
+		}
+		for (int32_t& position : positions) {
+			int64_t value;
+			if (!getSigned(chunk, cursor, value)) return false;
+			position = static_cast<int32_t>(value);
+		}
+	}
+	else {
+		if (framesDecoded == 0 || count != ids.size()) return false;
+		for (int32_t& position : positions) {
+			int64_t step;
+			if (!getSigned(chunk, cursor, step)) return false;
+			position += static_cast<int32_t>(step);
+		}
+	}
+	currentFrame = index[loadedChunk].firstFrame + frameOffset;
+	framesDecoded++;
+	return true;
+}
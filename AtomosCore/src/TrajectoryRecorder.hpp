@@ -0,0 +1,140 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm.hpp>
+#include <stdint.h>
+
+
+// One frame of a trajectory: the id and position of every object, in the order the world holds them.
+struct TrajectoryFrame {
+	uint64_t frame = 0;
+	std::vector<uint32_t> ids;
+	std::vector<glm::vec2> positions;
+};
+
+
+// Streams frames to a file from a thread of its own. The simulation only copies each frame into a spare
+// buffer; rounding, encoding and writing happen on the recorder thread, which the simulation waits for
+// only when it falls MAX_PENDING_FRAMES behind.
+//
+// Positions are rounded to multiples of quantum and stored as integers. Frames are grouped into chunks
+// of keyframeInterval: the first frame of a chunk is a keyframe holding ids and positions outright,
+// the rest only hold how far each object moved since the frame before, unless the ids changed, in which
+// case the frame is written out whole again. All numbers are zigzag varints, so objects that stay put
+// cost two bytes a frame. Each chunk goes to the file with one write, and an index of the chunks at the
+// end of the file lets TrajectoryReader start decoding at the keyframe before any frame.
+//
+// File: "ATRJ", version, quantum, keyframeInterval, then chunks of
+// { firstFrame u64, frameCount u32, bytes u32, frames }, then the index, { firstFrame u64, offset u64,
+// frameCount u32 } per chunk, and a footer { lastFrame u64, indexOffset u64, chunkCount u32, "ATRJ" }.
+// Little endian throughout.
+class TrajectoryRecorder {
+public:
+	static constexpr uint32_t MAGIC = 0x4a525441;		// "ATRJ"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr size_t MAX_PENDING_FRAMES = 4;
+
+	struct Stats {
+		uint64_t frames = 0;
+		uint64_t chunks = 0;
+		uint64_t rawBytes = 0;			// what the frames would take as plain ids and glm::vec2 positions
+		uint64_t writtenBytes = 0;
+	};
+
+	// 0 if path cannot be opened for writing
+	static TrajectoryRecorder* create(const std::string& path, float quantum, uint32_t keyframeInterval);
+	// writes out every queued frame, the last chunk and the index before returning
+	~TrajectoryRecorder();
+
+	// simulation thread: fill the buffer beginFrame returns, then hand it over with endFrame
+	TrajectoryFrame& beginFrame();
+	void endFrame();
+
+	// safe from any thread, counts the frames the recorder thread has encoded so far
+	Stats getStats() const;
+
+private:
+	TrajectoryRecorder(const std::string& path, float quantum, uint32_t keyframeInterval);
+	void run();
+	void encode(const TrajectoryFrame& frame);
+	void flushChunk();
+	void writeIndex();
+
+	struct ChunkEntry {
+		uint64_t firstFrame;
+		uint64_t offset;
+		uint32_t frameCount;
+	};
+
+	std::ofstream file;
+	float quantum;
+	uint32_t keyframeInterval;
+
+	// simulation thread and recorder thread
+	mutable std::mutex mutex;
+	std::condition_variable frameQueued;
+	std::condition_variable frameFreed;
+	std::deque<TrajectoryFrame*> pending;
+	std::vector<TrajectoryFrame*> spare;
+	TrajectoryFrame* filling = 0;
+	bool stopping = false;
+	Stats stats;
+
+	// recorder thread only
+	std::thread thread;
+	std::vector<uint8_t> chunk;
+	uint64_t chunkFirstFrame = 0;
+	uint32_t chunkFrames = 0;
+	std::vector<uint32_t> previousIds;
+	std::vector<int32_t> previousPositions;		// x, y pairs in quanta
+	std::vector<int32_t> currentPositions;
+	std::vector<ChunkEntry> index;
+	uint64_t offset = 0;
+	uint64_t lastFrame = 0;
+};
+
+
+// Random access into a file TrajectoryRecorder wrote. Reading a frame decodes its chunk from the keyframe
+// on; the chunk stays loaded, so walking forward through a chunk only decodes each frame once.
+class TrajectoryReader {
+public:
+	// 0 if path is not a finished trajectory file
+	static TrajectoryReader* open(const std::string& path);
+
+	uint64_t getFirstFrame() const;
+	uint64_t getLastFrame() const;
+	float getQuantum() const { return quantum; }
+
+	// false if frame was not recorded
+	bool readFrame(uint64_t frame, TrajectoryFrame& out);
+
+private:
+	TrajectoryReader() = default;
+	bool decodeNext();
+
+	struct ChunkEntry {
+		uint64_t firstFrame;
+		uint64_t offset;
+		uint32_t frameCount;
+	};
+
+	std::ifstream file;
+	float quantum = 1.f;
+	uint64_t lastFrame = 0;
+	std::vector<ChunkEntry> index;
+
+	// the loaded chunk and how far into it decoding has got
+	size_t loadedChunk = SIZE_MAX;
+	std::vector<uint8_t> chunk;
+	size_t cursor = 0;
+	uint32_t framesDecoded = 0;
+	uint64_t currentFrame = 0;
+	std::vector<uint32_t> ids;
+	std::vector<int32_t> positions;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+
+// Hands whole values from one writer thread to one reader thread without locking or copying.
+// The writer fills the back buffer and publishes it by swapping it with the middle one; the reader
+// swaps the middle buffer with its front one whenever something newer has been published.
+// Neither side ever waits on the other, the reader just keeps the last frame until a new one lands.
+template <typename T>
+class TripleBuffer {
+	static constexpr uint8_t INDEX_MASK = 0x3;
+	static constexpr uint8_t FRESH = 0x4;	// set while the middle buffer holds a frame the reader has not taken
+
+	T buffers[3];
+	std::atomic<uint8_t> middle = 1;
+	uint8_t back = 0;	// only the writer touches this
+	uint8_t front = 2;	// only the reader touches this
+
+public:
+	// writer thread only
+	T& getBack() { return buffers[back]; }
+	void publish() {
+		uint8_t previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+		back = previous & INDEX_MASK;
+	}
+
+	// reader thread only, returns whether a newer frame was taken
+	bool acquire() {
+		if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+		uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+		front = previous & INDEX_MASK;
+		return true;
+	}
+	const T& getFront() const { return buffers[front]; }
+};
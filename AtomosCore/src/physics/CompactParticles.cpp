@@ -0,0 +1,74 @@
+#include "CompactParticles.hpp"
+#include <gtc/packing.hpp>
+#include <cassert>
+#include <cmath>
+
+
+uint32_t colorFromID(uint32_t id) {
+	uint16_t hue = id % COLOR_HUES;
+	double fun = 1 - std::abs(fmod(static_cast<float>(hue) / 60.f, 2) - 1);
+	switch (hue / 60) {
+	case 0:
+		return 0xFF0000FF + (static_cast<int>(0xFF * fun) << 8);
+	case 1:
+		return 0xFF00FF00 + static_cast<int>(0xFF * fun);
+	case 2:
+		return 0xFF00FF00 + (static_cast<int>(0xFF * fun) << 16);
+	case 3:
+		return 0xFFFF0000 + (static_cast<int>(0xFF * fun) << 8);
+	case 4:
+		return 0xFFFF0000 + static_cast<int>(0xFF * fun);
+	case 5:
+		return 0xFF0000FF + (static_cast<int>(0xFF * fun) << 16);
+	default:
+		return 0xFFFFFFFF;
+	}
+}
+
+
+// particles tend to come in runs of the same species, so the last match is tried first
+bool CompactParticleStore::findSpecies(float radius, float mass, uint8_t& index) {
+	if (lastSpecies < species.size() && species[lastSpecies].radius == radius && species[lastSpecies].mass == mass) {
+		index = lastSpecies;
+		return true;
+	}
+	for (size_t i = 0; i < species.size(); i++) {
+		if (species[i].radius == radius && species[i].mass == mass) {
+			index = lastSpecies = static_cast<uint8_t>(i);
+			return true;
+		}
+	}
+
+	if (species.size() == MAX_SPECIES) return false;
+	species.push_back({ radius, mass });
+	index = lastSpecies = static_cast<uint8_t>(species.size() - 1);
+	return true;
+}
+
+// positions left of or above the origin are clamped onto it
+bool CompactParticleStore::push(glm::vec2 position, glm::vec2 velocity, float radius, float mass, uint32_t id) {
+	uint8_t kind;
+	if (!findSpecies(radius, mass, kind)) return false;
+
+	glm::vec2 scaled = glm::max(position, glm::vec2(0)) / cellSize;
+	glm::vec2 cell = glm::floor(scaled);
+	glm::vec2 offset = glm::min((scaled - cell) * OFFSET_SCALE, glm::vec2(OFFSET_SCALE - 1));
+	assert(cell.x < MAX_CELL_COLUMNS && cell.y < MAX_CELL_ROWS);
+
+	CompactParticle particle;
+	particle.cellXAndHue = static_cast<uint32_t>(cell.x) | id % COLOR_HUES << 23;
+	particle.cellYAndSpecies = static_cast<uint32_t>(cell.y) | static_cast<uint32_t>(kind) << 24;
+	particle.offsetX = static_cast<uint16_t>(offset.x);
+	particle.offsetY = static_cast<uint16_t>(offset.y);
+	particle.velocityX = glm::packHalf1x16(velocity.x);
+	particle.velocityY = glm::packHalf1x16(velocity.y);
+	particles.push_back(particle);
+	return true;
+}
+
+// the species go too, so a store that overflowed its table starts afresh on the next snapshot
+void CompactParticleStore::clear() {
+	particles.clear();
+	species.clear();
+	lastSpecies = 0;
+}
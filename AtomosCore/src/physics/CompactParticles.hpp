@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+#include <glm.hpp>
+#include <stdint.h>
+#include <bit>
+
+
+// hue wheel colour for the nth object, so colours never need to be stored
+uint32_t colorFromID(uint32_t id);
+constexpr uint32_t COLOR_HUES = 360;		// ids this far apart share a colour
+
+
+// 16 byte stand-in for a PhysicsObject in passes that stream over every object and only read its motion.
+// Positions are fixed point inside their cell, velocities are half floats, and radius and mass come from
+// a small species table; everything is widened back to floats when a particle is read. The colour is kept
+// as the object's id modulo COLOR_HUES, which is all colorFromID looks at.
+struct CompactParticle {
+	uint32_t cellXAndHue;			// hue in the top 9 bits
+	uint32_t cellYAndSpecies;		// species in the top 8 bits
+	uint16_t offsetX;				// position inside the cell in 1/65536ths of a cell
+	uint16_t offsetY;
+	uint16_t velocityX;				// IEEE half precision
+	uint16_t velocityY;
+};
+static_assert(sizeof(CompactParticle) == 16, "CompactParticle must stay 16 bytes");
+
+
+// Widens a half float with integer ops only. Reads happen once per particle per pass, so this sits in
+// the header where streaming loops can inline it.
+inline float halfToFloat(uint16_t half) {
+	constexpr uint32_t SHIFTED_EXPONENT = 0x7C00u << 13;
+	uint32_t bits = (half & 0x7FFFu) << 13;
+	uint32_t exponent = bits & SHIFTED_EXPONENT;
+	bits += (127 - 15) << 23;
+
+	if (exponent == SHIFTED_EXPONENT) bits += (128 - 16) << 23;		// inf and nan stay inf and nan
+	else if (exponent == 0) {										// denormals get renormalized
+		bits += 1 << 23;
+		bits = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) - std::bit_cast<float>(113u << 23));
+	}
+	return std::bit_cast<float>(bits | (half & 0x8000u) << 16);
+}
+
+
+class CompactParticleStore {
+public:
+	struct Species {
+		float radius;
+		float mass;
+	};
+
+	// a particle widened back to full precision
+	struct Particle {
+		glm::vec2 position;
+		glm::vec2 velocity;
+		float radius;
+		float mass;
+		uint32_t color;
+	};
+
+	static constexpr uint32_t MAX_CELL_COLUMNS = 1 << 23;
+	static constexpr uint32_t MAX_CELL_ROWS = 1 << 24;
+	static constexpr size_t MAX_SPECIES = 256;
+	static constexpr float OFFSET_SCALE = 65536.f;
+
+private:
+	float cellSize;
+	std::vector<CompactParticle> particles;
+	std::vector<Species> species;
+	uint8_t lastSpecies = 0;
+
+	// false once the table holds MAX_SPECIES and this is yet another one
+	bool findSpecies(float radius, float mass, uint8_t& index);
+
+public:
+	CompactParticleStore(float cellSize_ = 8.f) : cellSize(cellSize_) {}
+
+	// false, leaving the store as it was, if the particle would need more than MAX_SPECIES species
+	bool push(glm::vec2 position, glm::vec2 velocity, float radius, float mass, uint32_t id);
+	void clear();
+	void reserve(size_t count) { particles.reserve(count); }
+	void setCellSize(float size) { cellSize = size; }
+
+	size_t size() const { return particles.size(); }
+	size_t numSpecies() const { return species.size(); }
+
+	// the cell position was binned into, left of or above the origin counting as the origin
+	glm::uvec2 getCell(size_t i) const {
+		return { particles[i].cellXAndHue & (MAX_CELL_COLUMNS - 1), particles[i].cellYAndSpecies & (MAX_CELL_ROWS - 1) };
+	}
+	// offsets decode to the middle of their 1/65536th so the error is at most half a step either way
+	glm::vec2 getPosition(size_t i) const {
+		const CompactParticle& particle = particles[i];
+		float x = static_cast<float>(particle.cellXAndHue & (MAX_CELL_COLUMNS - 1)) + (particle.offsetX + .5f) / OFFSET_SCALE;
+		float y = static_cast<float>(particle.cellYAndSpecies & (MAX_CELL_ROWS - 1)) + (particle.offsetY + .5f) / OFFSET_SCALE;
+		return glm::vec2(x, y) * cellSize;
+	}
+	glm::vec2 getVelocity(size_t i) const {
+		return { halfToFloat(particles[i].velocityX), halfToFloat(particles[i].velocityY) };
+	}
+	const Species& getSpecies(size_t i) const { return species[particles[i].cellYAndSpecies >> 24]; }
+	uint32_t getColor(size_t i) const { return colorFromID(particles[i].cellXAndHue >> 23); }
+	Particle get(size_t i) const {
+		const Species& kind = getSpecies(i);
+		return { getPosition(i), getVelocity(i), kind.radius, kind.mass, getColor(i) };
+	}
+
+	template <typename F>
+	void forEach(F&& function) const {
+		for (size_t i = 0; i < particles.size(); i++) function(get(i));
+	}
+};
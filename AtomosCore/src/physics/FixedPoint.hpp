@@ -0,0 +1,64 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <bit>
+#include <stdint.h>
+
+
+// Signed fixed point numbers held as raw int32_t, FRACTION_BITS of their 32 bits after the point, so
+// Fixed<16> is Q16.16 and covers a world up to 32767 units across. No result here depends on a float: the
+// two conversions only scale by a power of two, which is exact, and round once the IEEE way, so every
+// result depends on the operands alone and not on the compiler, its flags or the machine.
+// Kernels keep their state as raw values in plain int32 arrays and widen to 64 bits for products.
+template <int FRACTION_BITS>
+struct Fixed {
+	static_assert(FRACTION_BITS > 0 && FRACTION_BITS < 31, "Fixed needs a fraction and an integer part");
+
+	static constexpr int BITS = FRACTION_BITS;
+	static constexpr int64_t ONE = int64_t(1) << FRACTION_BITS;
+
+	// for constants, rounded by the compiler once and for all
+	static constexpr int32_t constant(float value) {
+		return static_cast<int32_t>(value * ONE + (value < 0.f ? -.5f : .5f));
+	}
+
+	// out of range values saturate, nan becomes zero
+	static int32_t fromFloat(float value) {
+		float scaled = value * static_cast<float>(ONE);
+		if (scaled != scaled) return 0;
+		scaled = std::clamp(scaled, static_cast<float>(INT32_MIN), 2147483520.f);		// the largest float below 2^31
+		return static_cast<int32_t>(std::lrint(scaled));
+	}
+
+	static float toFloat(int32_t raw) {
+		return static_cast<float>(raw) / static_cast<float>(ONE);
+	}
+
+	// a * b for raw values with any number of fraction bits between them, rounded half up
+	static int64_t multiply(int64_t a, int64_t b) {
+		return (a * b + ONE / 2) >> BITS;
+	}
+
+	// a / b as a raw value, both raw or both in the same scale, rounded towards zero; a and b may be as
+	// wide as a squared distance, when a << BITS would not fit the quotient is built in two halves
+	static int64_t divide(int64_t a, int64_t b) {
+		constexpr int64_t WIDEST = INT64_MAX >> FRACTION_BITS;
+		if (a <= WIDEST && a >= -WIDEST) return a * ONE / b;
+		return a / b * ONE + a % b * ONE / b;
+	}
+
+	// floor of the square root of a value below 2^62, the square root of a raw square is a raw length.
+	// Newton's method on integers: started from a power of two at or above the root it falls every step
+	// until it reaches the floor, and stops there.
+	static int32_t squareRoot(uint64_t value) {
+		if (value < 2) return static_cast<int32_t>(value);
+		uint64_t root = uint64_t(1) << (std::bit_width(value) + 1) / 2;
+		while (true) {
+			uint64_t next = (root + value / root) / 2;
+			if (next >= root) return static_cast<int32_t>(root);
+			root = next;
+		}
+	}
+};
+
+using Q16_16 = Fixed<16>;
@@ -0,0 +1,2006 @@
+#include "Physics.hpp"
+#include <iostream>
+#include <thread>
+#include <cmath>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+
+#include "Timer.hpp"
+#include "Tracer.hpp"
+
+constexpr float ELASTICITY = .6f;
+constexpr int BOUNDARY_MARGIN = 4;		// keeps objects clear of the frame drawn around the world
+constexpr float GRAVITATIONAL_FORCE = 45.f;
+constexpr float MAX_SPEED = SPAWNER_EXIT_SPEED * 3.5f;
+constexpr int CELL_SIZE = (OBJECT_SIZE * 2);
+constexpr int MAX_OBJECTS = 5;
+constexpr float DENSITY = 2.f;
+constexpr int COLLISION_ITERATIONS = 5;
+constexpr float EPSILON = 0.01;
+constexpr float MAX_TIME_STEP(1.f / 60.f);
+constexpr float MAX_SPECULATIVE_TIME_STEP(1.f / 20.f);
+constexpr float CFL_FRACTION = .5f;		// of its radius, the furthest an object may move in one substep
+constexpr uint32_t MAX_SUBSTEPS = 16;
+constexpr float FULL_REBUILD_FRACTION = .25f;
+constexpr float NEIGHBOUR_SKIN = OBJECT_SIZE * .5f;
+constexpr size_t COMMAND_QUEUE_CAPACITY = 4096;
+constexpr size_t PARALLEL_SPAWN_MINIMUM = 2048;		// smaller batches are built on the calling thread
+constexpr int DETERMINISTIC_TILES = 32;		// enough for sixteen workers a wave, fixed so no pool size changes the tiles
+constexpr int MIN_TILE_WIDTH = 2;			// a tile reaches one row or column past each edge, so one between keeps two apart
+constexpr glm::vec2 SPAWNER_OFFSET = glm::vec2(-OBJECT_SIZE * 2, OBJECT_SIZE * 2 + 2);
+
+// longest step update() lets each narrow phase take
+template <typename NarrowPhase> constexpr float maxTimeStep = MAX_TIME_STEP;
+template <> constexpr float maxTimeStep<SpeculativeNarrowPhase> = MAX_SPECULATIVE_TIME_STEP;
+
+
+
+
+static uint32_t objCount = 0;
+
+static void addCellToOccupancy(PhysicsWorld::FrameMetrics& metrics, size_t count) {
+	metrics.occupiedCells++;
+	metrics.maxObjectsPerCell = std::max(metrics.maxObjectsPerCell, static_cast<uint32_t>(count));
+	metrics.cellOccupancy[std::min<size_t>(count, PhysicsWorld::OCCUPANCY_BUCKETS) - 1]++;
+}
+
+PhysicsWorld::PhysicsObject::PhysicsObject(PhysicsWorld* ctrlr, glm::vec2 pos, float r, glm::vec2 v) :
+	PhysicsObject(ctrlr, pos, r, v, nextID++, objCount++) {}
+
+PhysicsWorld::PhysicsObject::PhysicsObject(PhysicsWorld* ctrlr, glm::vec2 pos, float r, glm::vec2 v, uint32_t id_, uint32_t colorIndex) :
+	PhysicsComponent{ ctrlr, id_ } {
+	position = pos;
+	velocity = v;
+	acceleration = glm::vec2(0);
+	infrastepTime = 0.f;
+	radius = r;
+	mass = r * r * DENSITY;
+
+	color = colorFromID(colorIndex);
+}
+
+PhysicsWorld::PhysicsObject::~PhysicsObject() {
+	objCount--;
+}
+
+void PhysicsWorld::PhysicsObject::accelerate(glm::vec2 acc) {
+	acceleration += acc;
+}
+
+
+void PhysicsWorld::PhysicsObject::enforceBoundaries(uint32_t width, uint32_t height) {
+	if (position.y > height - radius - BOUNDARY_MARGIN) {
+		position.y = height - radius - BOUNDARY_MARGIN;
+		velocity.y *= -ELASTICITY;
+	}
+	if (position.y < radius + BOUNDARY_MARGIN) {
+		position.y = radius + BOUNDARY_MARGIN;
+		velocity.y *= -ELASTICITY;
+	}
+
+	if (position.x > width - radius - BOUNDARY_MARGIN) {
+		position.x = width - radius - BOUNDARY_MARGIN;
+		velocity.x *= -ELASTICITY;
+	}
+	if (position.x < radius + BOUNDARY_MARGIN) {
+		position.x = radius + BOUNDARY_MARGIN;
+		velocity.x *= -ELASTICITY;
+	}
+}
+
+
+void PhysicsWorld::PhysicsObject::update(float timeDelta) {
+	velocity += acceleration * timeDelta;
+	acceleration = glm::vec2(0);
+	if (glm::length(velocity) < EPSILON) velocity = glm::vec2(0);
+}
+
+void PhysicsWorld::PhysicsObject::move(float timeDelta) {
+	position += velocity * timeDelta;
+}
+
+size_t PhysicsWorld::CollisionNode::count() const {
+	return numObjects;
+}
+
+bool PhysicsWorld::CollisionNode::insert(PhysicsObject* obj) {
+	obj->cell = index;
+	if (!head) {
+		head = tail = obj;
+		obj->next = obj->previous = obj;
+		numObjects++;
+		return 1;
+	}
+
+	head->previous = tail->next = obj;
+	obj->previous = tail;
+	obj->next = head;
+	tail = obj;
+	numObjects++;
+	return 1;
+}
+
+bool PhysicsWorld::CollisionNode::insertSorted(PhysicsObject* obj) {
+	if (!head || tail->id < obj->id) return insert(obj);
+	PhysicsObject* after = head;
+	while (after->id < obj->id) after = after->next;
+	obj->cell = index;
+	obj->previous = after->previous;
+	obj->next = after;
+	after->previous->next = obj;
+	after->previous = obj;
+	if (after == head) head = obj;
+	numObjects++;
+	return 1;
+}
+
+// the list is doubly linked, so the object unlinks itself without walking the cell
+bool PhysicsWorld::CollisionNode::remove(PhysicsObject* obj) {
+	assert(obj->next && obj->cell == index);
+	if (obj->next == obj) {
+		head = 0;
+		tail = 0;
+	}
+	else {
+		if (obj == head) head = obj->next;
+		if (obj == tail) tail = obj->previous;
+		obj->previous->next = obj->next;
+		obj->next->previous = obj->previous;
+	}
+	obj->previous = obj->next = 0;
+	numObjects--;
+	return 1;
+}
+
+void PhysicsWorld::CollisionNode::clear() {
+	numObjects = 0;
+	head = tail = 0;
+}
+
+
+PhysicsWorld::CollisionGrid::CollisionGrid(uint32_t m, uint32_t n) : GridContainer<CollisionNode>(m, n, CELL_SIZE) {}
+
+
+template <typename PairFunction>
+void PhysicsWorld::CollisionGrid::checkCellCollisions(CollisionNode* cell1, CollisionNode* cell2, PairFunction& onPair) {
+	cell1->forEach([&](PhysicsObject* obj1) {
+		cell2->forEach([&](PhysicsObject* obj2) {
+			if (obj1 != obj2) onPair(obj1, obj2);
+		});
+	});
+}
+
+template <typename PairFunction>
+void PhysicsWorld::CollisionGrid::handleCollisions(int widthLow, int widthHigh, PairFunction& onPair) {
+	if (widthHigh >= static_cast<int>(width)) widthHigh = width - 1;
+
+
+	for (int j = 1; j < static_cast<int>(height) - 1; j++) {
+		for (int i = widthLow; i < widthHigh; i++) {
+			CollisionNode* currentNode = getCell(i, j);
+			if (currentNode->count() == 0) continue;
+			for (int dj = -1; dj <= 1; dj++) {
+				for (int di = -1; di <= 1; di++) {
+					CollisionNode* adjacentNode = getCell(i + di, j + dj);
+					if (adjacentNode->count() == 0) continue;
+					checkCellCollisions(currentNode, adjacentNode, onPair);
+				}
+			}
+		}
+	}
+}
+
+
+PhysicsWorld::CollisionHash::CollisionHash() : SpatialHash<CollisionNode>(CELL_SIZE) {}
+
+template <typename PairFunction>
+void PhysicsWorld::CollisionHash::handleCollisions(const std::vector<uint32_t>& cells, uint32_t low, uint32_t high, PairFunction& onPair) {
+	for (uint32_t k = low; k < high; k++) {
+		CollisionNode* currentNode = getOccupiedCell(cells[k]);
+		glm::ivec2 index = getOccupiedIndex(cells[k]);
+		for (int dj = -1; dj <= 1; dj++) {
+			for (int di = -1; di <= 1; di++) {
+				CollisionNode* adjacentNode = getCell(index.x + di, index.y + dj);
+				if (!adjacentNode) continue;
+				currentNode->forEach([&](PhysicsObject* obj1) {
+					adjacentNode->forEach([&](PhysicsObject* obj2) {
+						if (obj1 != obj2) onPair(obj1, obj2);
+					});
+				});
+			}
+		}
+	}
+}
+
+
+
+// Schedulers
+
+template <typename F>
+void SerialScheduler::parallelFor(ThreadPool* pool, int low, int high, F&& function) {
+	function(low, high);
+}
+
+template <typename F>
+void ThreadedScheduler::parallelFor(ThreadPool* pool, int low, int high, F&& function) {
+	std::array<std::future<void>, THREAD_COUNT> tasks;
+	float step = static_cast<float>(high - low) / static_cast<float>(THREAD_COUNT);
+	for (int i = 0; i < THREAD_COUNT; i++) {
+		int rangeLow = low + static_cast<int>(step * i);
+		int rangeHigh = (i == THREAD_COUNT - 1) ? high : low + static_cast<int>(step * (i + 1));
+		tasks[i] = pool->addTaskTo(i, [&function, rangeLow, rangeHigh]() { function(rangeLow, rangeHigh); });
+	}
+	for (auto& task : tasks) task.wait();
+}
+
+// the tiles of [low, high) are [low + (high - low) * t / tiles, low + (high - low) * (t + 1) / tiles)
+static int tileCount(int low, int high) {
+	return std::clamp((high - low) / MIN_TILE_WIDTH, 1, DETERMINISTIC_TILES);
+}
+
+// the last tile that starts at or before index
+static int tileContaining(int index, int low, int high) {
+	int64_t width = std::max(high - low, 1);
+	return static_cast<int>((static_cast<int64_t>(index - low + 1) * tileCount(low, high) - 1) / width);
+}
+
+template <typename F>
+void DeterministicScheduler::parallelFor(ThreadPool* pool, int low, int high, F&& function) {
+	int tiles = tileCount(low, high);
+	std::array<std::future<void>, (DETERMINISTIC_TILES + 1) / 2> tasks;
+	for (int parity = 0; parity < 2; parity++) {
+		int queued = 0;
+		for (int tile = parity; tile < tiles; tile += 2) {
+			int tileLow = low + static_cast<int>(static_cast<int64_t>(high - low) * tile / tiles);
+			int tileHigh = low + static_cast<int>(static_cast<int64_t>(high - low) * (tile + 1) / tiles);
+			tasks[queued++] = pool->addTaskTo(tile / 2, [&function, tileLow, tileHigh]() { function(tileLow, tileHigh); });
+		}
+		for (int i = 0; i < queued; i++) tasks[i].wait();
+	}
+}
+
+
+
+// Broad phases
+
+template <typename Controller, typename PairFunction>
+void BruteForceBroadPhase::forEachPair(Controller& controller, PairFunction onPair) {
+	for (PhysicsWorld::PhysicsObject* obj1 : controller.objects) {
+		for (PhysicsWorld::PhysicsObject* obj2 : controller.objects) {
+			if (obj1 != obj2) onPair(obj1, obj2);
+		}
+	}
+}
+
+
+UniformGridBroadPhase::UniformGridBroadPhase(uint32_t simulationWidth, uint32_t simulationHeight) {
+	uint32_t gridWidth = simulationWidth / CELL_SIZE + 1;
+	uint32_t gridHeight = simulationHeight / CELL_SIZE + 1;
+
+	grid = new PhysicsWorld::CollisionGrid(gridWidth, gridHeight);
+}
+
+UniformGridBroadPhase::~UniformGridBroadPhase() {
+	delete grid;
+}
+
+// Objects remember the cell they are linked into, and moved() queued the ones that left it since the last
+// call, so only those are unlinked and relinked; one that has moved back since is left where it is. New
+// objects were queued by add, destroyed ones were unlinked by remove. A step where more than
+// FULL_REBUILD_FRACTION of the objects moved relinks everything instead. Appending the movers leaves each
+// cell in an order that depends on every step before, so a scheduler that wants a canonical order has
+// them linked in by id.
+template <typename Controller>
+void UniformGridBroadPhase::rebuild(Controller& controller) {
+	size_t count = moverCount.load(std::memory_order_relaxed);
+	if (relinkAll || count > controller.objects.size() * FULL_REBUILD_FRACTION) {
+		fullRebuild(controller);
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		PhysicsWorld::PhysicsObject* obj = movers[i];
+		obj->moverSlot = UINT32_MAX;
+		bool inside = grid->contains(obj->position);
+		if (obj->next && inside && grid->getGridIndex(obj->position) == obj->cell) continue;
+		if (obj->next) grid->getCell(obj->cell)->remove(obj);
+		if (!link(controller, obj)) obj->previous = obj->next = 0;
+	}
+	moverCount.store(0, std::memory_order_relaxed);
+}
+
+template <typename Controller>
+void UniformGridBroadPhase::fullRebuild(Controller& controller) {
+	size_t count = moverCount.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < count; i++) movers[i]->moverSlot = UINT32_MAX;
+	moverCount.store(0, std::memory_order_relaxed);
+	if (movers.size() < controller.objects.size()) movers.resize(controller.objects.size());
+
+	grid->clear();
+	for (PhysicsWorld::PhysicsObject* obj : controller.objects) {
+		if (!link(controller, obj)) obj->previous = obj->next = 0;
+	}
+	relinkAll = false;
+}
+
+template <typename Controller>
+bool UniformGridBroadPhase::link(Controller& controller, PhysicsWorld::PhysicsObject* obj) {
+	if constexpr (decltype(controller.scheduler)::canonicalOrder) return grid->insertSorted(obj);
+	else return grid->insert(obj);
+}
+
+// Uses the same bands as forEachPair, so the cells each worker walks are the ones it allocated, and the
+// objects it resolves are copies it made. Objects are counted into the column they sit in, those left or
+// right of the walked columns into the nearest one, so every band finds its own in one range. The old
+// cells took their objects with them and the copies are linked nowhere, the next rebuild links
+// everything in again.
+template <typename Controller>
+void UniformGridBroadPhase::placeMemory(Controller& controller) {
+	std::vector<PhysicsWorld::PhysicsObject*>& objects = controller.objects;
+	size_t count = moverCount.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < count; i++) movers[i]->moverSlot = UINT32_MAX;
+	moverCount.store(0, std::memory_order_relaxed);
+	if (grid->getWidth() < 3) return;
+
+	int lastColumn = static_cast<int>(grid->getWidth()) - 2;
+	float cellSize = static_cast<float>(grid->getNodeSize());
+	auto columnOf = [&](const PhysicsWorld::PhysicsObject* obj) {
+		return static_cast<uint32_t>(std::clamp(floorf(obj->position.x / cellSize), 1.f, static_cast<float>(lastColumn)));
+	};
+	std::vector<uint32_t> columnEnd(grid->getWidth() + 1, 0);
+	for (const PhysicsWorld::PhysicsObject* obj : objects) columnEnd[columnOf(obj) + 1]++;
+	for (size_t x = 1; x < columnEnd.size(); x++) columnEnd[x] += columnEnd[x - 1];
+	std::vector<uint32_t> byColumn(objects.size());
+	std::vector<uint32_t> filled(columnEnd.begin(), columnEnd.end() - 1);
+	for (size_t i = 0; i < objects.size(); i++) byColumn[filled[columnOf(objects[i])]++] = static_cast<uint32_t>(i);
+
+	std::vector<PhysicsWorld::PhysicsObject*> old(objects);
+	controller.scheduler.parallelFor(controller.pool, 1, grid->getWidth() - 1, [&](int widthLow, int widthHigh) {
+		grid->reallocateColumns(widthLow, widthHigh);
+		for (uint32_t k = columnEnd[widthLow]; k < columnEnd[widthHigh]; k++) {
+			PhysicsWorld::PhysicsObject* copy = new PhysicsWorld::PhysicsObject(*objects[byColumn[k]]);
+			copy->previous = copy->next = 0;
+			objects[byColumn[k]] = copy;
+		}
+	});
+	// the objects live on in their copies, so the colour counter gets back what the destructors take
+	for (PhysicsWorld::PhysicsObject* obj : old) delete obj;
+	objCount += static_cast<uint32_t>(old.size());
+	relinkAll = true;
+}
+
+// cells that are about to be relinked from scratch may not hold obj any more, so those are left alone
+template <typename Controller>
+void UniformGridBroadPhase::remove(Controller& controller, PhysicsWorld::PhysicsObject* obj) {
+	if (obj->next && !relinkAll) grid->getCell(obj->cell)->remove(obj);
+	obj->previous = obj->next = 0;
+	if (obj->moverSlot == UINT32_MAX) return;
+	size_t last = moverCount.fetch_sub(1, std::memory_order_relaxed) - 1;
+	movers[obj->moverSlot] = movers[last];
+	movers[obj->moverSlot]->moverSlot = obj->moverSlot;
+	obj->moverSlot = UINT32_MAX;
+}
+
+// new objects are not linked anywhere, so moved() queues every one of them that is inside the grid
+template <typename Controller>
+void UniformGridBroadPhase::add(Controller& controller, size_t first, size_t count) {
+	if (movers.size() < controller.objects.size()) movers.resize(controller.objects.size());
+	for (size_t i = first; i < first + count; i++) moved(controller, controller.objects[i]);
+}
+
+// Each object is queued at most once, by the first thread to claim its slot, so moverCount never passes
+// the length of movers, which add and fullRebuild keep at least as long as objects.
+template <typename Controller>
+void UniformGridBroadPhase::moved(Controller& controller, PhysicsWorld::PhysicsObject* obj) {
+	if (relinkAll) return;
+	bool inside = grid->contains(obj->position);
+	if ((obj->next != 0) == inside && (!inside || grid->getGridIndex(obj->position) == obj->cell)) return;
+
+	uint32_t unqueued = UINT32_MAX;
+	std::atomic_ref<uint32_t> slot(obj->moverSlot);
+	if (slot.load(std::memory_order_relaxed) != UINT32_MAX || !slot.compare_exchange_strong(unqueued, UINT32_MAX - 1, std::memory_order_relaxed)) return;
+	size_t index = moverCount.fetch_add(1, std::memory_order_relaxed);
+	assert(index < movers.size());
+	movers[index] = obj;
+	slot.store(static_cast<uint32_t>(index), std::memory_order_relaxed);
+}
+
+// walks the objects rather than the cells, counting each cell once through its head
+template <typename Controller>
+void UniformGridBroadPhase::collectOccupancy(Controller& controller, PhysicsWorld::FrameMetrics& metrics) {
+	for (PhysicsWorld::PhysicsObject* obj : controller.objects) {
+		if (!obj->next) continue;
+		PhysicsWorld::CollisionNode* node = grid->getCell(obj->cell);
+		if (node->head == obj) addCellToOccupancy(metrics, node->count());
+	}
+}
+
+template <typename Controller, typename PairFunction>
+void UniformGridBroadPhase::forEachPair(Controller& controller, PairFunction onPair) {
+	controller.scheduler.parallelFor(controller.pool, 1, grid->getWidth() - 1, [&](int widthLow, int widthHigh) {
+		grid->handleCollisions(widthLow, widthHigh, onPair);
+	});
+}
+
+
+
+// the columns UniformGridBroadPhase walks for the same world
+SpatialHashBroadPhase::SpatialHashBroadPhase(uint32_t simulationWidth, uint32_t simulationHeight) {
+	grid = new PhysicsWorld::CollisionHash();
+	columnLow = 1;
+	columnHigh = std::max(static_cast<int>(simulationWidth / CELL_SIZE), columnLow + 1);
+}
+
+SpatialHashBroadPhase::~SpatialHashBroadPhase() {
+	delete grid;
+}
+
+// cells outside the walked columns go to the tile at that edge, which reaches that far out alone
+template <typename Controller>
+void SpatialHashBroadPhase::rebuild(Controller& controller) {
+	grid->clear();
+	for (PhysicsWorld::PhysicsObject* obj : controller.objects) {
+		grid->insert(obj);
+	}
+
+	uint32_t cells = static_cast<uint32_t>(grid->getNumCells());
+	int tiles = tileCount(columnLow, columnHigh);
+	auto tileOf = [&](uint32_t n) {
+		int column = std::clamp(grid->getOccupiedIndex(n).x, columnLow, columnHigh - 1);
+		return tileContaining(column, columnLow, columnHigh);
+	};
+	tileStart.assign(tiles + 1, 0);
+	for (uint32_t n = 0; n < cells; n++) tileStart[tileOf(n) + 1]++;
+	for (int t = 0; t < tiles; t++) tileStart[t + 1] += tileStart[t];
+	std::vector<uint32_t> filled(tileStart.begin(), tileStart.end() - 1);
+	tileCells.resize(cells);
+	for (uint32_t n = 0; n < cells; n++) tileCells[filled[tileOf(n)]++] = n;
+
+	auto rowMajor = [&](uint32_t a, uint32_t b) {
+		glm::ivec2 keyA = grid->getOccupiedIndex(a), keyB = grid->getOccupiedIndex(b);
+		return keyA.y != keyB.y ? keyA.y < keyB.y : keyA.x < keyB.x;
+	};
+	for (int t = 0; t < tiles; t++) std::sort(tileCells.begin() + tileStart[t], tileCells.begin() + tileStart[t + 1], rowMajor);
+}
+
+template <typename Controller, typename PairFunction>
+void SpatialHashBroadPhase::forEachPair(Controller& controller, PairFunction onPair) {
+	int tiles = static_cast<int>(tileStart.size()) - 1;
+	for (int parity = 0; parity < 2; parity++) {
+		controller.scheduler.parallelFor(controller.pool, 0, std::max((tiles - parity + 1) / 2, 0), [&](int low, int high) {
+			for (int k = low; k < high; k++) {
+				int tile = 2 * k + parity;
+				grid->handleCollisions(tileCells, tileStart[tile], tileStart[tile + 1], onPair);
+			}
+		});
+	}
+}
+
+template <typename Controller>
+void SpatialHashBroadPhase::collectOccupancy(Controller& controller, PhysicsWorld::FrameMetrics& metrics) {
+	for (size_t n = 0; n < grid->getNumCells(); n++) addCellToOccupancy(metrics, grid->getOccupiedCell(n)->count());
+}
+
+
+
+// Two objects that each moved less than half the skin cannot have closed more than the skin between them,
+// so every pair that can touch is still on the lists.
+template <typename Controller>
+void NeighbourListBroadPhase::rebuild(Controller& controller) {
+	bool stale = addedAtBuild != controller.objectsAdded || destroyedAtBuild != controller.objectsDestroyed;
+	if (!stale) {
+		float limit = NEIGHBOUR_SKIN * .5f;
+		std::atomic<bool> moved = false;
+		controller.scheduler.parallelFor(controller.pool, 0, static_cast<int>(controller.objects.size()), [&](int low, int high) {
+			for (int i = low; i < high && !moved.load(std::memory_order_relaxed); i++) {
+				glm::vec2 offset = controller.objects[i]->position - builtAt[i];
+				if (glm::dot(offset, offset) > limit * limit) moved.store(true, std::memory_order_relaxed);
+			}
+		});
+		stale = moved;
+	}
+	if (stale) buildLists(controller);
+}
+
+// the bins are sorted serially, the lists are counted and then written in parallel so each can go straight into place
+template <typename Controller>
+void NeighbourListBroadPhase::buildLists(Controller& controller) {
+	const std::vector<PhysicsWorld::PhysicsObject*>& objects = controller.objects;
+	uint32_t count = static_cast<uint32_t>(objects.size());
+
+	float maxRadius = 0.f;
+	for (PhysicsWorld::PhysicsObject* obj : objects) maxRadius = fmax(maxRadius, obj->radius);
+	binSize = 2.f * maxRadius + NEIGHBOUR_SKIN + reach;
+	binsWide = static_cast<uint32_t>(controller.simulationWidth / binSize) + 1;
+	binsHigh = static_cast<uint32_t>(controller.simulationHeight / binSize) + 1;
+
+	binOf.resize(count);
+	binStart.assign(binsWide * binsHigh + 1, 0);
+	for (uint32_t i = 0; i < count; i++) {
+		glm::vec2 position = objects[i]->position;
+		uint32_t x = static_cast<uint32_t>(std::clamp(static_cast<int>(position.x / binSize), 0, static_cast<int>(binsWide) - 1));
+		uint32_t y = static_cast<uint32_t>(std::clamp(static_cast<int>(position.y / binSize), 0, static_cast<int>(binsHigh) - 1));
+		binOf[i] = y * binsWide + x;
+		binStart[binOf[i] + 1]++;
+	}
+	for (size_t b = 1; b < binStart.size(); b++) binStart[b] += binStart[b - 1];
+	binned.resize(count);
+	std::vector<uint32_t> fill(binStart.begin(), binStart.end() - 1);
+	for (uint32_t i = 0; i < count; i++) binned[fill[binOf[i]]++] = i;
+
+	offsets.resize(count + 1);
+	offsets[0] = 0;
+	controller.scheduler.parallelFor(controller.pool, 0, static_cast<int>(count), [&](int low, int high) {
+		for (int i = low; i < high; i++) {
+			uint32_t found = 0;
+			forEachNearby(controller, i, [&found](uint32_t other) { found++; });
+			offsets[i + 1] = found;
+		}
+	});
+	for (uint32_t i = 0; i < count; i++) offsets[i + 1] += offsets[i];
+
+	neighbours.resize(offsets[count]);
+	builtAt.resize(count);
+	controller.scheduler.parallelFor(controller.pool, 0, static_cast<int>(count), [&](int low, int high) {
+		for (int i = low; i < high; i++) {
+			uint32_t* next = neighbours.data() + offsets[i];
+			forEachNearby(controller, i, [&next](uint32_t other) { *next++ = other; });
+			builtAt[i] = objects[i]->position;
+		}
+	});
+
+	addedAtBuild = controller.objectsAdded;
+	destroyedAtBuild = controller.objectsDestroyed;
+	controller.counters.listBuilds.fetch_add(1, std::memory_order_relaxed);
+}
+
+// grows with headroom so a scene that speeds up slowly does not rebuild every step, and shrinks again once far too wide
+template <typename Controller>
+void NeighbourListBroadPhase::lookAhead(Controller& controller, float distance) {
+	if (distance > reach || distance < reach * .5f) {
+		reach = distance * 1.25f;
+		destroyedAtBuild = UINT64_MAX;
+	}
+}
+
+template <typename Controller, typename F>
+void NeighbourListBroadPhase::forEachNearby(Controller& controller, uint32_t object, F&& function) {
+	PhysicsWorld::PhysicsObject* obj = controller.objects[object];
+	int x = static_cast<int>(binOf[object] % binsWide);
+	int y = static_cast<int>(binOf[object] / binsWide);
+	for (int j = std::max(y - 1, 0); j <= std::min(y + 1, static_cast<int>(binsHigh) - 1); j++) {
+		for (int i = std::max(x - 1, 0); i <= std::min(x + 1, static_cast<int>(binsWide) - 1); i++) {
+			uint32_t bin = j * binsWide + i;
+			for (uint32_t n = binStart[bin]; n < binStart[bin + 1]; n++) {
+				uint32_t other = binned[n];
+				if (other == object) continue;
+				float limit = obj->radius + controller.objects[other]->radius + NEIGHBOUR_SKIN + reach;
+				glm::vec2 offset = controller.objects[other]->position - obj->position;
+				if (glm::dot(offset, offset) <= limit * limit) function(other);
+			}
+		}
+	}
+}
+
+// walks the objects bin row by bin row, so as with the grid only the rows at the edge of a band touch objects of another band
+template <typename Controller, typename PairFunction>
+void NeighbourListBroadPhase::forEachPair(Controller& controller, PairFunction onPair) {
+	controller.scheduler.parallelFor(controller.pool, 0, static_cast<int>(binsHigh), [&](int rowLow, int rowHigh) {
+		for (uint32_t n = binStart[rowLow * binsWide]; n < binStart[rowHigh * binsWide]; n++) {
+			uint32_t object = binned[n];
+			for (uint32_t k = offsets[object]; k < offsets[object + 1]; k++) onPair(controller.objects[object], controller.objects[neighbours[k]]);
+		}
+	});
+}
+
+// bins as they were at the last build
+template <typename Controller>
+void NeighbourListBroadPhase::collectOccupancy(Controller& controller, PhysicsWorld::FrameMetrics& metrics) {
+	for (size_t b = 0; b + 1 < binStart.size(); b++) {
+		if (binStart[b + 1] > binStart[b]) addCellToOccupancy(metrics, binStart[b + 1] - binStart[b]);
+	}
+}
+
+
+
+// Narrow phases
+
+bool DiscreteNarrowPhase::checkCollision(PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2, uint32_t simWidth, uint32_t simHeight) {
+	glm::vec2 distanceVector = obj1->position - obj2->position;
+	float dist = glm::length(distanceVector);
+	float minDist = obj1->radius + obj2->radius;
+	// objects clamped into the same corner can end up exactly on top of each other, part them along x
+	if (dist == 0.f) {
+		distanceVector = glm::vec2(EPSILON, 0.f);
+		dist = EPSILON;
+	}
+	if (dist < minDist) {
+		glm::vec2 collisionAxis = distanceVector / dist;
+		float delta = minDist - dist;
+
+		glm::vec2 repositionDistance1 = .5f * delta * glm::normalize(collisionAxis);
+		glm::vec2 repositionDistance2 = -.5f * delta * glm::normalize(collisionAxis);
+		float factorMass1 = 2 * obj2->mass / (obj1->mass + obj2->mass);
+		float factorMass2 = 2 * obj1->mass / (obj1->mass + obj2->mass);
+		glm::vec2 positionDiffVector = distanceVector;
+		glm::vec2 velocityDiffVector = obj1->velocity - obj2->velocity;
+
+		glm::vec2 velocityAdjustment1 = factorMass1 * glm::dot(velocityDiffVector, positionDiffVector) / glm::dot(positionDiffVector, positionDiffVector) * positionDiffVector;
+		glm::vec2 velocityAdjustment2 = factorMass2 * glm::dot(-velocityDiffVector, -positionDiffVector) / glm::dot(positionDiffVector, positionDiffVector) * -positionDiffVector;
+
+		obj1->position += repositionDistance1;
+		obj2->position += repositionDistance2;
+
+		obj1->velocity -= velocityAdjustment1 * ELASTICITY;
+		obj2->velocity -= velocityAdjustment2 * ELASTICITY;
+
+
+
+		obj1->enforceBoundaries(simWidth, simHeight);
+		obj2->enforceBoundaries(simWidth, simHeight);
+		return true;
+	}
+	return false;
+}
+
+template <typename Controller>
+void DiscreteNarrowPhase::step(Controller& controller, float dt) {
+	{
+		Tracer::Scope stage("integrate");
+		for (PhysicsWorld::PhysicsObject* obj : controller.objects) {
+			obj->accelerate(glm::vec2(0, GRAVITATIONAL_FORCE));
+			obj->update(dt);
+			obj->move(dt);
+			obj->enforceBoundaries(controller.simulationWidth, controller.simulationHeight);
+			controller.broadPhase.moved(controller, obj);
+		}
+	}
+
+	for (int i{ COLLISION_ITERATIONS }; i--;) {
+		{
+			Tracer::Scope stage("broad phase");
+			controller.broadPhase.rebuild(controller);
+		}
+		Tracer::Scope stage("collisions");
+		controller.broadPhase.forEachPair(controller, [&controller](PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2) {
+			controller.counters.pairTests.fetch_add(1, std::memory_order_relaxed);
+			if (!checkCollision(obj1, obj2, controller.simulationWidth, controller.simulationHeight)) return;
+			controller.broadPhase.moved(controller, obj1);
+			controller.broadPhase.moved(controller, obj2);
+			controller.counters.contacts.fetch_add(1, std::memory_order_relaxed);
+		});
+	}
+}
+
+
+// Nothing but this narrow phase writes the floats unless objects were added, destroyed or pushed, so
+// otherwise the integers are current as they are. When they may not be, an object is taken back in from
+// its floats if it is new here, has moved in the list or was changed from outside.
+template <typename Number>
+template <typename Controller>
+void FixedPointNarrowPhase<Number>::load(Controller& controller) {
+	bool current = ids.size() == controller.objects.size() && addedAtLoad == controller.objectsAdded &&
+		destroyedAtLoad == controller.objectsDestroyed && pushedAtLoad == controller.objectsPushed;
+	if (current) return;
+	addedAtLoad = controller.objectsAdded;
+	destroyedAtLoad = controller.objectsDestroyed;
+	pushedAtLoad = controller.objectsPushed;
+
+	size_t kept = std::min(ids.size(), controller.objects.size());
+	ids.resize(controller.objects.size());
+	positions.resize(controller.objects.size());
+	velocities.resize(controller.objects.size());
+	radii.resize(controller.objects.size());
+	for (size_t i = 0; i < controller.objects.size(); i++) {
+		const PhysicsWorld::PhysicsObject* obj = controller.objects[i];
+		bool current = i < kept && ids[i] == obj->id &&
+			Number::toFloat(positions[i].x) == obj->position.x && Number::toFloat(positions[i].y) == obj->position.y &&
+			Number::toFloat(velocities[i].x) == obj->velocity.x && Number::toFloat(velocities[i].y) == obj->velocity.y;
+		if (current) continue;
+		ids[i] = obj->id;
+		positions[i] = { Number::fromFloat(obj->position.x), Number::fromFloat(obj->position.y) };
+		velocities[i] = { Number::fromFloat(obj->velocity.x), Number::fromFloat(obj->velocity.y) };
+		radii[i] = Number::fromFloat(obj->radius);
+	}
+}
+
+template <typename Number>
+void FixedPointNarrowPhase<Number>::store(PhysicsWorld::PhysicsObject* obj, size_t i) const {
+	obj->position = { Number::toFloat(positions[i].x), Number::toFloat(positions[i].y) };
+	obj->velocity = { Number::toFloat(velocities[i].x), Number::toFloat(velocities[i].y) };
+}
+
+template <typename Number>
+void FixedPointNarrowPhase<Number>::enforceBoundaries(size_t i, int32_t width, int32_t height) {
+	constexpr int32_t bounce = -Number::constant(ELASTICITY);
+	int32_t low = radii[i] + Number::constant(BOUNDARY_MARGIN);
+	glm::ivec2& position = positions[i];
+	glm::ivec2& velocity = velocities[i];
+	if (position.y > height - low) {
+		position.y = height - low;
+		velocity.y = static_cast<int32_t>(Number::multiply(velocity.y, bounce));
+	}
+	if (position.y < low) {
+		position.y = low;
+		velocity.y = static_cast<int32_t>(Number::multiply(velocity.y, bounce));
+	}
+	if (position.x > width - low) {
+		position.x = width - low;
+		velocity.x = static_cast<int32_t>(Number::multiply(velocity.x, bounce));
+	}
+	if (position.x < low) {
+		position.x = low;
+		velocity.x = static_cast<int32_t>(Number::multiply(velocity.x, bounce));
+	}
+}
+
+// DiscreteNarrowPhase::checkCollision in raw fixed point. Squared lengths stay 64 bit so nothing is
+// compared after a square root, and both objects take the same push with opposite signs.
+template <typename Number>
+bool FixedPointNarrowPhase<Number>::checkCollision(size_t i, size_t j, int32_t width, int32_t height) {
+	constexpr int32_t apart = Number::constant(EPSILON);
+	glm::ivec2 distanceVector = positions[i] - positions[j];
+	int64_t distanceSquared = static_cast<int64_t>(distanceVector.x) * distanceVector.x + static_cast<int64_t>(distanceVector.y) * distanceVector.y;
+	int64_t minDist = radii[i] + radii[j];
+	if (distanceSquared == 0) {
+		distanceVector = { apart, 0 };
+		distanceSquared = static_cast<int64_t>(apart) * apart;
+	}
+	if (distanceSquared >= minDist * minDist) return false;
+
+	int64_t dist = std::max(Number::squareRoot(static_cast<uint64_t>(distanceSquared)), 1);
+	int64_t halfOverlap = Number::divide(minDist - dist, 2 * dist);
+	glm::ivec2 push = { static_cast<int32_t>(Number::multiply(halfOverlap, distanceVector.x)), static_cast<int32_t>(Number::multiply(halfOverlap, distanceVector.y)) };
+	positions[i] += push;
+	positions[j] -= push;
+
+	// masses go as the squared radii, so the density drops out of the mass factors, which add up to two
+	int64_t mass1 = static_cast<int64_t>(radii[i]) * radii[i];
+	int64_t mass2 = static_cast<int64_t>(radii[j]) * radii[j];
+	int64_t massFactor1 = mass1 == mass2 ? Number::ONE : Number::divide(2 * mass2, mass1 + mass2);
+	glm::ivec2 velocityDiffVector = velocities[i] - velocities[j];
+	int64_t closing = static_cast<int64_t>(velocityDiffVector.x) * distanceVector.x + static_cast<int64_t>(velocityDiffVector.y) * distanceVector.y;
+	int64_t ratio = Number::multiply(Number::divide(closing, distanceSquared), Number::constant(ELASTICITY));
+	int64_t factor1 = Number::multiply(ratio, massFactor1);
+	int64_t factor2 = Number::multiply(ratio, 2 * Number::ONE - massFactor1);
+	velocities[i] -= glm::ivec2(static_cast<int32_t>(Number::multiply(factor1, distanceVector.x)), static_cast<int32_t>(Number::multiply(factor1, distanceVector.y)));
+	velocities[j] += glm::ivec2(static_cast<int32_t>(Number::multiply(factor2, distanceVector.x)), static_cast<int32_t>(Number::multiply(factor2, distanceVector.y)));
+
+	enforceBoundaries(i, width, height);
+	enforceBoundaries(j, width, height);
+	return true;
+}
+
+// Every object needs enough substeps that it moves at most CFL_FRACTION of its radius in one, at its speed
+// after a frame of gravity capped at MAX_SPEED, which is ceil(travel / allowance) of them. The same
+// rounding up as the float version, without dividing by a radius.
+template <typename Number>
+template <typename Controller>
+uint32_t FixedPointNarrowPhase<Number>::chooseSubsteps(Controller& controller, float dt) {
+	load(controller);
+	int32_t frameLength = Number::fromFloat(dt);
+	int64_t fall = Number::multiply(Number::constant(GRAVITATIONAL_FORCE), frameLength);
+	int64_t maxSpeed = 0;
+	int64_t substeps = 1;
+	for (size_t i = 0; i < ids.size(); i++) {
+		int64_t speedSquared = static_cast<int64_t>(velocities[i].x) * velocities[i].x + static_cast<int64_t>(velocities[i].y) * velocities[i].y;
+		int64_t speed = std::min<int64_t>(Number::squareRoot(static_cast<uint64_t>(speedSquared)) + fall, Number::constant(MAX_SPEED));
+		int64_t travel = Number::multiply(speed, frameLength);
+		int64_t allowance = std::max<int64_t>(Number::multiply(Number::constant(CFL_FRACTION), radii[i]), 1);
+		maxSpeed = std::max(maxSpeed, speed);
+		substeps = std::max(substeps, (travel + allowance - 1) / allowance);
+	}
+
+	controller.metrics.maxSpeed = Number::toFloat(static_cast<int32_t>(maxSpeed));
+	substeps = std::min<int64_t>(substeps, MAX_SUBSTEPS);
+	substepLength = static_cast<int32_t>(frameLength / substeps);
+	return static_cast<uint32_t>(substeps);
+}
+
+// the same stages as DiscreteNarrowPhase::step, pairs are found from the floats each pass writes back
+template <typename Number>
+template <typename Controller>
+void FixedPointNarrowPhase<Number>::step(Controller& controller, float dt) {
+	constexpr int64_t restingSquared = static_cast<int64_t>(Number::constant(EPSILON)) * Number::constant(EPSILON);
+	int32_t width = static_cast<int32_t>(controller.simulationWidth * Number::ONE);
+	int32_t height = static_cast<int32_t>(controller.simulationHeight * Number::ONE);
+	int32_t timeStep = substepLength;
+	int32_t fall = static_cast<int32_t>(Number::multiply(Number::constant(GRAVITATIONAL_FORCE), timeStep));
+	{
+		Tracer::Scope stage("integrate");
+		load(controller);
+		for (size_t i = 0; i < controller.objects.size(); i++) {
+			glm::ivec2& velocity = velocities[i];
+			velocity.y += fall;
+			if (static_cast<int64_t>(velocity.x) * velocity.x + static_cast<int64_t>(velocity.y) * velocity.y < restingSquared) velocity = glm::ivec2(0);
+			positions[i] += glm::ivec2(static_cast<int32_t>(Number::multiply(velocity.x, timeStep)), static_cast<int32_t>(Number::multiply(velocity.y, timeStep)));
+			enforceBoundaries(i, width, height);
+			store(controller.objects[i], i);
+			controller.broadPhase.moved(controller, controller.objects[i]);
+		}
+	}
+
+	for (int i{ COLLISION_ITERATIONS }; i--;) {
+		{
+			Tracer::Scope stage("broad phase");
+			controller.broadPhase.rebuild(controller);
+		}
+		Tracer::Scope stage("collisions");
+		controller.broadPhase.forEachPair(controller, [&](PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2) {
+			controller.counters.pairTests.fetch_add(1, std::memory_order_relaxed);
+			size_t index1 = controller.handleSlots[obj1->handle.index].denseIndex;
+			size_t index2 = controller.handleSlots[obj2->handle.index].denseIndex;
+			if (!checkCollision(index1, index2, width, height)) return;
+			store(obj1, index1);
+			store(obj2, index2);
+			controller.broadPhase.moved(controller, obj1);
+			controller.broadPhase.moved(controller, obj2);
+			controller.counters.contacts.fetch_add(1, std::memory_order_relaxed);
+		});
+	}
+}
+
+
+// Only pairs that are apart and closing fast enough to touch within dt are handled. Both objects take the
+// velocity they would have after the contact for the whole step and are moved back by the distance that
+// adds up before the contact, so after move() they sit where bouncing at the contact would have left them.
+bool SpeculativeNarrowPhase::speculate(PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2, float dt) {
+	glm::vec2 distanceVector = obj1->position - obj2->position;
+	float dist = glm::length(distanceVector);
+	float gap = dist - (obj1->radius + obj2->radius);
+	if (gap < 0.f || dist == 0.f) return false;
+
+	glm::vec2 normal = distanceVector / dist;
+	float closing = glm::dot(obj2->velocity - obj1->velocity, normal);
+	if (closing * dt <= gap) return false;
+
+	float contactTime = gap / closing;
+	glm::vec2 velocityAdjustment1 = 2 * obj2->mass / (obj1->mass + obj2->mass) * closing * ELASTICITY * normal;
+	glm::vec2 velocityAdjustment2 = -2 * obj1->mass / (obj1->mass + obj2->mass) * closing * ELASTICITY * normal;
+	obj1->velocity += velocityAdjustment1;
+	obj2->velocity += velocityAdjustment2;
+	obj1->position -= velocityAdjustment1 * contactTime;
+	obj2->position -= velocityAdjustment2 * contactTime;
+	return true;
+}
+
+// the same bounce against the walls enforceBoundaries would clamp the object to
+void SpeculativeNarrowPhase::speculateBoundaries(PhysicsWorld::PhysicsObject* obj, float dt, uint32_t simWidth, uint32_t simHeight) {
+	glm::vec2 low = glm::vec2(obj->radius + BOUNDARY_MARGIN);
+	glm::vec2 high = glm::vec2(simWidth, simHeight) - low;
+	for (int axis = 0; axis < 2; axis++) {
+		float speed = obj->velocity[axis];
+		float distance = speed > 0.f ? high[axis] - obj->position[axis] : obj->position[axis] - low[axis];
+		if (speed == 0.f || distance < 0.f || fabs(speed) * dt <= distance) continue;
+
+		float contactTime = distance / fabs(speed);
+		float velocityAdjustment = -speed * (1.f + ELASTICITY);
+		obj->velocity[axis] += velocityAdjustment;
+		obj->position[axis] -= velocityAdjustment * contactTime;
+	}
+}
+
+template <typename Controller>
+void SpeculativeNarrowPhase::step(Controller& controller, float dt) {
+	float maxSpeed = 0.f;
+	{
+		Tracer::Scope stage("integrate");
+		for (PhysicsWorld::PhysicsObject* obj : controller.objects) {
+			obj->accelerate(glm::vec2(0, GRAVITATIONAL_FORCE));
+			obj->update(dt);
+			maxSpeed = fmax(maxSpeed, glm::length(obj->velocity));
+		}
+	}
+	{
+		Tracer::Scope stage("broad phase");
+		controller.broadPhase.lookAhead(controller, 2.f * maxSpeed * dt);
+		controller.broadPhase.rebuild(controller);
+	}
+
+	for (int i{ COLLISION_ITERATIONS }; i--;) {
+		Tracer::Scope stage("speculative contacts");
+		controller.broadPhase.forEachPair(controller, [&controller, dt](PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2) {
+			controller.counters.pairTests.fetch_add(1, std::memory_order_relaxed);
+			if (speculate(obj1, obj2, dt)) controller.counters.contacts.fetch_add(1, std::memory_order_relaxed);
+		});
+	}
+
+	{
+		Tracer::Scope stage("move");
+		for (PhysicsWorld::PhysicsObject* obj : controller.objects) {
+			speculateBoundaries(obj, dt, controller.simulationWidth, controller.simulationHeight);
+			obj->move(dt);
+			obj->enforceBoundaries(controller.simulationWidth, controller.simulationHeight);
+			controller.broadPhase.moved(controller, obj);
+		}
+	}
+	{
+		Tracer::Scope stage("broad phase");
+		controller.broadPhase.rebuild(controller);
+	}
+	Tracer::Scope stage("collisions");
+	controller.broadPhase.forEachPair(controller, [&controller](PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2) {
+		controller.counters.pairTests.fetch_add(1, std::memory_order_relaxed);
+		if (!DiscreteNarrowPhase::checkCollision(obj1, obj2, controller.simulationWidth, controller.simulationHeight)) return;
+		controller.broadPhase.moved(controller, obj1);
+		controller.broadPhase.moved(controller, obj2);
+		controller.counters.contacts.fetch_add(1, std::memory_order_relaxed);
+	});
+}
+
+
+template <typename Controller>
+bool ContinuousNarrowPhase::predictCollision(Controller& controller, PhysicsWorld::PhysicsObject* object, float dt, PhysicsWorld::CollisionEvent& event) {
+	using CollisionEvent = PhysicsWorld::CollisionEvent;
+	PhysicsWorld::CollisionGrid* grid = controller.broadPhase.grid;
+	uint32_t width = grid->getWidth();
+	uint32_t height = grid->getHeight();
+	float nodeSize = static_cast<float>(grid->getNodeSize());
+
+	float occuranceTime;
+
+	float eventTime = dt;
+	bool eventOccured = false;
+	PhysicsWorld::Direction eventDirection = PhysicsWorld::NONE;
+	CollisionEvent::CollisionType type = CollisionEvent::ERROR;
+	PhysicsWorld::PhysicsObject* predicateObject = 0;
+
+
+	PhysicsWorld::CollisionNode* currentNode = grid->getCell(object->cell);
+	glm::vec2 newPosition = object->position + object->velocity * (dt - object->infrastepTime);
+
+	// check for cell changes, leaving the edges of the grid to the boundary checks
+	if (newPosition.x < currentNode->minimumBound.x && object->velocity.x < 0 && currentNode->index.x > 0) {
+		occuranceTime = object->infrastepTime + std::abs(currentNode->minimumBound.x - object->position.x) / std::abs(object->velocity.x);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::LEFT;
+			type = CollisionEvent::CELL_CHANGE;
+		}
+	}
+	if (newPosition.y < currentNode->minimumBound.y && object->velocity.y < 0 && currentNode->index.y > 0) {
+		occuranceTime = object->infrastepTime + std::abs(currentNode->minimumBound.y - object->position.y) / std::abs(object->velocity.y);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::UP;
+			type = CollisionEvent::CELL_CHANGE;
+		}
+	}
+	if (newPosition.x > currentNode->maximumBound.x && object->velocity.x > 0 && currentNode->index.x < width - 1) {
+		occuranceTime = object->infrastepTime + std::abs(currentNode->maximumBound.x - object->position.x) / std::abs(object->velocity.x);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::RIGHT;
+			type = CollisionEvent::CELL_CHANGE;
+		}
+	}
+	if (newPosition.y > currentNode->maximumBound.y && object->velocity.y > 0 && currentNode->index.y < height - 1) {
+		occuranceTime = object->infrastepTime + std::abs(currentNode->maximumBound.y - object->position.y) / std::abs(object->velocity.y);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::DOWN;
+			type = CollisionEvent::CELL_CHANGE;
+		}
+	}
+
+	// check for boundary enforcements
+	if (newPosition.x < object->radius && object->velocity.x < 0) {
+		occuranceTime = object->infrastepTime + std::max(object->position.x - object->radius, 0.f) / std::abs(object->velocity.x);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::LEFT;
+			type = CollisionEvent::BOUNDARY_ENFORCEMENT;
+		}
+	}
+	if (newPosition.y < object->radius && object->velocity.y < 0) {
+		occuranceTime = object->infrastepTime + std::max(object->position.y - object->radius, 0.f) / std::abs(object->velocity.y);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::UP;
+			type = CollisionEvent::BOUNDARY_ENFORCEMENT;
+		}
+	}
+	if (newPosition.x > width * nodeSize - object->radius && object->velocity.x > 0) {
+		occuranceTime = object->infrastepTime + std::max(width * nodeSize - object->radius - object->position.x, 0.f) / std::abs(object->velocity.x);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::RIGHT;
+			type = CollisionEvent::BOUNDARY_ENFORCEMENT;
+		}
+	}
+	if (newPosition.y > height * nodeSize - object->radius && object->velocity.y > 0) {
+		occuranceTime = object->infrastepTime + std::max(height * nodeSize - object->radius - object->position.y, 0.f) / std::abs(object->velocity.y);
+		if (occuranceTime < eventTime) {
+			eventOccured = true;
+			eventTime = occuranceTime;
+			eventDirection = PhysicsWorld::DOWN;
+			type = CollisionEvent::BOUNDARY_ENFORCEMENT;
+		}
+	}
+
+	// check for object collisions
+	uint64_t pairTests = 0;
+	for (int dj = -1; dj <= 1; dj++) {
+		for (int di = -1; di <= 1; di++) {
+			int64_t xAdjacentNodeIndex = static_cast<int64_t>(currentNode->index.x) + di;
+			int64_t yAdjacentNodeIndex = static_cast<int64_t>(currentNode->index.y) + dj;
+			if (xAdjacentNodeIndex < 0 || yAdjacentNodeIndex < 0 || xAdjacentNodeIndex >= static_cast<int64_t>(width) || yAdjacentNodeIndex >= static_cast<int64_t>(height)) continue;
+			PhysicsWorld::CollisionNode* adjacentNode = grid->getCell(xAdjacentNodeIndex, yAdjacentNodeIndex);
+			if (adjacentNode->count() == 0) continue;
+			adjacentNode->forEach([&](PhysicsWorld::PhysicsObject* obj2) {
+				if (object == obj2) return;
+				pairTests++;
+				// perform quadratic equation to find event time
+				glm::vec2 distanceDifference = object->position - obj2->position;
+				glm::vec2 velocityDifference = object->velocity - obj2->velocity;
+				float minDistance = object->radius + obj2->radius;
+
+				float distanceDifferenceInnerProduct = glm::dot(distanceDifference, distanceDifference);
+				float velocityDifferenceInnerProduct = glm::dot(velocityDifference, velocityDifference);
+				float bterm = glm::dot(distanceDifference, velocityDifference) / velocityDifferenceInnerProduct;
+				float determinate = (bterm * bterm) - ((distanceDifferenceInnerProduct - minDistance * minDistance) / velocityDifferenceInnerProduct);
+
+				// 1 solution if == 0, 2 solutions if >0, no real solutions if <0
+				// balls that are not closing on each other faster than EPSILON can't collide, however close they are
+				bool closing = glm::dot(distanceDifference, velocityDifference) < -EPSILON * minDistance;
+				if (determinate >= 0 && closing) {
+					// we only care about the earliest collision time
+					occuranceTime = object->infrastepTime - bterm - sqrt(determinate);
+					if (occuranceTime >= object->infrastepTime && occuranceTime < eventTime) {
+						eventOccured = true;
+						type = CollisionEvent::BALL_BALL;
+						eventTime = occuranceTime;
+						eventDirection = PhysicsWorld::NONE;
+						predicateObject = obj2;
+					}
+				}
+			});
+		}
+	}
+
+	controller.counters.pairTests.fetch_add(pairTests, std::memory_order_relaxed);
+
+	if (eventOccured) {
+		event = { type, eventTime, object, eventDirection, predicateObject, object->eventStamp, predicateObject ? predicateObject->eventStamp : 0 };
+	}
+	return eventOccured;
+}
+
+template <typename Controller>
+void ContinuousNarrowPhase::addCollisionsToQueue(Controller& controller, PhysicsWorld::PhysicsObject* object, float dt) {
+	PhysicsWorld::CollisionEvent newEvent;
+	if (predictCollision(controller, object, dt, newEvent)) eventQueue.push(newEvent);
+}
+
+// Every object's first prediction only reads the grid and the other objects, so the bands run on the
+// scheduler and write into their own slots. The queue is then built from all of them in one heapify.
+template <typename Controller>
+void ContinuousNarrowPhase::predictAll(Controller& controller, float dt) {
+	using CollisionEvent = PhysicsWorld::CollisionEvent;
+	std::vector<PhysicsWorld::PhysicsObject*>& objects = controller.objects;
+
+	setupEvents.assign(objects.size(), CollisionEvent{});
+	controller.scheduler.parallelFor(controller.pool, 0, static_cast<int>(objects.size()), [&](int low, int high) {
+		for (int i = low; i < high; i++) predictCollision(controller, objects[i], dt, setupEvents[i]);
+	});
+
+	std::erase_if(setupEvents, [](const CollisionEvent& event) { return event.type == CollisionEvent::ERROR; });
+	eventQueue = PhysicsWorld::CollisionQueue(std::less<CollisionEvent>(), std::move(setupEvents));
+}
+
+template <typename Controller>
+size_t ContinuousNarrowPhase::predictEvents(Controller& controller, float dt) {
+	eventQueue = PhysicsWorld::CollisionQueue();
+	for (PhysicsWorld::PhysicsObject* obj : controller.objects) addCollisionsToQueue(controller, obj, dt);
+	return eventQueue.size();
+}
+
+template <typename Controller>
+void ContinuousNarrowPhase::checkCollisionsQueue(Controller& controller, float dt) {
+	using CollisionEvent = PhysicsWorld::CollisionEvent;
+	PhysicsWorld::CollisionGrid* grid = controller.broadPhase.grid;
+
+	uint64_t processed = 0;
+	uint64_t discarded = 0;
+	uint64_t contacts = 0;
+	CollisionEvent nextCollision;
+	PhysicsWorld::CollisionNode* ppp = 0;
+	while (!eventQueue.empty()) {
+		processed++;
+		nextCollision = eventQueue.top(); eventQueue.pop();
+
+		// a newer prediction replaced this one, or the other ball has changed course since it was made
+		if (nextCollision.subjectStamp != nextCollision.subjectObject->eventStamp) {
+			discarded++;
+			continue;
+		}
+		if (nextCollision.predicateObject && nextCollision.predicateStamp != nextCollision.predicateObject->eventStamp) {
+			discarded++;
+			addCollisionsToQueue(controller, nextCollision.subjectObject, dt);
+			continue;
+		}
+
+		switch (nextCollision.type) {
+		case CollisionEvent::CELL_CHANGE:
+		{
+			// the object sits exactly on the shared edge, so the new cell comes from the direction rather than the position
+			glm::uvec2 newCell = nextCollision.subjectObject->cell;
+			if (nextCollision.eventDirection == PhysicsWorld::LEFT) newCell.x--;
+			if (nextCollision.eventDirection == PhysicsWorld::RIGHT) newCell.x++;
+			if (nextCollision.eventDirection == PhysicsWorld::UP) newCell.y--;
+			if (nextCollision.eventDirection == PhysicsWorld::DOWN) newCell.y++;
+
+			nextCollision.subjectObject->position += nextCollision.subjectObject->velocity * static_cast<float>(nextCollision.eventTime - nextCollision.subjectObject->infrastepTime);
+
+			ppp = grid->getCell(nextCollision.subjectObject->cell);
+			ppp->remove(nextCollision.subjectObject);
+			ppp = grid->getCell(newCell.x, newCell.y);
+			ppp->insert(nextCollision.subjectObject);
+		}
+			break;
+
+
+		case CollisionEvent::BOUNDARY_ENFORCEMENT:
+			nextCollision.subjectObject->position += nextCollision.subjectObject->velocity * static_cast<float>(nextCollision.eventTime - nextCollision.subjectObject->infrastepTime);
+			if (nextCollision.eventDirection == PhysicsWorld::UP || nextCollision.eventDirection == PhysicsWorld::DOWN) nextCollision.subjectObject->velocity.y *= -ELASTICITY;
+			if (nextCollision.eventDirection == PhysicsWorld::LEFT || nextCollision.eventDirection == PhysicsWorld::RIGHT) nextCollision.subjectObject->velocity.x *= -ELASTICITY;
+			nextCollision.subjectObject->velocity *= ELASTICITY;
+			break;
+
+
+		case CollisionEvent::BALL_BALL:
+		{
+			contacts++;
+			// move the balls up to the collision point
+			glm::vec2 newSubjectPosition = nextCollision.subjectObject->position + nextCollision.subjectObject->velocity * (nextCollision.eventTime - nextCollision.subjectObject->infrastepTime);
+			glm::vec2 newPredicatePosition = nextCollision.predicateObject->position + nextCollision.predicateObject->velocity * (nextCollision.eventTime - nextCollision.predicateObject->infrastepTime);
+
+			nextCollision.subjectObject->position = newSubjectPosition;
+			nextCollision.predicateObject->position = newPredicatePosition;
+
+			float factorMass1 = 2 * nextCollision.predicateObject->mass / (nextCollision.subjectObject->mass + nextCollision.predicateObject->mass);
+			float factorMass2 = 2 * nextCollision.subjectObject->mass / (nextCollision.subjectObject->mass + nextCollision.predicateObject->mass);
+			glm::vec2 positionDiffVector = nextCollision.subjectObject->position - nextCollision.predicateObject->position;
+			glm::vec2 velocityDiffVector = nextCollision.subjectObject->velocity - nextCollision.predicateObject->velocity;
+
+			glm::vec2 velocityAdjustment1 = factorMass1 * glm::dot(velocityDiffVector, positionDiffVector) / glm::dot(positionDiffVector, positionDiffVector) * positionDiffVector;
+			glm::vec2 velocityAdjustment2 = factorMass2 * glm::dot(-velocityDiffVector, -positionDiffVector) / glm::dot(positionDiffVector, positionDiffVector) * -positionDiffVector;
+
+			nextCollision.subjectObject->velocity -= velocityAdjustment1 * ELASTICITY;
+			nextCollision.predicateObject->velocity -= velocityAdjustment2 * ELASTICITY;
+
+			nextCollision.predicateObject->infrastepTime = nextCollision.eventTime;
+			nextCollision.predicateObject->eventStamp++;
+			if (nextCollision.predicateObject->infrastepTime < dt) addCollisionsToQueue(controller, nextCollision.predicateObject, dt);
+		}
+			break;
+		default:
+			std::cerr << "Bad Collision Event Detected\n\tSubject Object ID: " << nextCollision.subjectObject->id
+				<< "\n\tTime of Event: " << nextCollision.eventTime << std::endl;
+			exit(1000);
+			break;
+		}
+		nextCollision.subjectObject->infrastepTime = nextCollision.eventTime;
+		nextCollision.subjectObject->eventStamp++;
+		if (nextCollision.subjectObject->infrastepTime < dt) addCollisionsToQueue(controller, nextCollision.subjectObject, dt);
+	}
+
+	controller.counters.eventsProcessed.fetch_add(processed, std::memory_order_relaxed);
+	controller.counters.eventsDiscarded.fetch_add(discarded, std::memory_order_relaxed);
+	controller.counters.contacts.fetch_add(contacts, std::memory_order_relaxed);
+}
+
+template <typename Controller>
+void ContinuousNarrowPhase::step(Controller& controller, float dt) {
+	{
+		Tracer::Scope stage("broad phase");
+		controller.broadPhase.rebuild(controller);
+	}
+
+	// predictions read the other objects' velocities, so every object is updated before any are predicted
+	for (auto obj : controller.objects) {
+		obj->accelerate(glm::vec2(0, GRAVITATIONAL_FORCE));
+		obj->update(dt);
+	}
+
+	// add all of the objects into the collision queue
+	{
+		Tracer::Scope stage("predict");
+		predictAll(controller, dt);
+	}
+
+	// go through the queue and run all of the potential collisions
+	{
+		Tracer::Scope stage("event queue");
+		checkCollisionsQueue(controller, dt);
+	}
+
+	// update all objects to the end of the timestep
+	Tracer::Scope stage("advance");
+	for (auto obj : controller.objects) {
+		if (obj->infrastepTime != dt) {
+			glm::vec2 newPos = obj->position + obj->velocity * (dt - obj->infrastepTime);
+			obj->position = newPos;
+		}
+		// reset infrastepTime for the next frame
+		obj->infrastepTime = 0.f;
+		controller.broadPhase.moved(controller, obj);
+	}
+}
+
+
+template <typename T>
+PhysicsWorld::ObjectSpawner<T>::ObjectSpawner(PhysicsWorld* ctrlr, glm::vec2 p, glm::vec2 dir, float mag) {
+	controller = ctrlr;
+	position = p;
+	exitVelocity = mag * dir;
+}
+
+// a shot that fell due age seconds ago has already travelled that far from the muzzle
+template <typename T>
+void PhysicsWorld::ObjectSpawner<T>::shoot(float age) {
+	controller->pendingSpawns.push(position + exitVelocity * age, exitVelocity, OBJECT_SIZE);
+}
+
+// fires every shot that fell due during timeDelta, so a long step does not slow the spawner down
+template <typename T>
+void PhysicsWorld::ObjectSpawner<T>::update(float timeDelta) {
+	if (!keepShooting) return;
+	timeSinceLastShot += timeDelta;
+	while (timeSinceLastShot > REFRACTORY_TIME) {
+		timeSinceLastShot -= REFRACTORY_TIME;
+		shoot(timeSinceLastShot);
+	}
+}
+
+template <typename T>
+void PhysicsWorld::ObjectSpawner<T>::start() {
+	keepShooting = true;
+}
+
+template <typename T>
+void PhysicsWorld::ObjectSpawner<T>::stop() {
+	keepShooting = false;
+}
+
+template <typename T>
+void PhysicsWorld::ObjectSpawner<T>::restore(float clock, bool shooting) {
+	timeSinceLastShot = clock;
+	keepShooting = shooting;
+}
+
+
+PhysicsWorld::PhysicsWorld(uint32_t simulationWidth_, uint32_t simulationHeight_) {
+	nextID = 0;
+
+	simulationWidth = simulationWidth_;
+	simulationHeight = simulationHeight_;
+
+	pool = new ThreadPool(THREAD_COUNT);
+	commands = new CommandQueue<PhysicsCommand>(COMMAND_QUEUE_CAPACITY);
+	snapshots = new TripleBuffer<RenderSnapshot>();
+
+	loadScene(SceneLibrary::fountain(simulationWidth, simulationHeight, MAX_OBJECTS));
+}
+
+PhysicsWorld::~PhysicsWorld() {
+	for (PhysicsObject* obj : objects) delete obj;
+	for (auto spawner : spawners) delete spawner;
+	delete pool;
+	delete commands;
+	delete snapshots;
+	delete sharedFrames;
+	delete trajectory;
+	delete rewind;
+}
+
+void PhysicsWorld::addSpawner(glm::vec2 position, glm::vec2 direction, float magnitude) {
+	spawners.emplace_back(new ObjectSpawner<PhysicsObject>(this, position, direction, magnitude));
+}
+
+void PhysicsWorld::addSpawnerN(glm::vec2 p, glm::vec2 dir, float mag, uint32_t n) {
+	for (uint32_t i = 0; i < n; i++) addSpawner(p + SPAWNER_OFFSET * static_cast<float>(i), dir, mag);
+}
+
+void PhysicsWorld::loadScene(const Scene& scene) {
+	std::vector<ObjectHandle> handles;
+	handles.reserve(objects.size());
+	for (PhysicsObject* obj : objects) handles.push_back(obj->handle);
+	destroyObjects(handles);
+
+	for (auto spawner : spawners) delete spawner;
+	spawners.clear();
+	for (const Scene::Spawner& spawner : scene.spawners) addSpawnerN(spawner.position, spawner.direction, spawner.speed, spawner.count);
+
+	ParticleArrays bodies;
+	for (const Scene::Body& body : scene.bodies) bodies.push(body.position, body.velocity, body.radius);
+	addObjects(bodies);
+	pendingSpawns.clear();
+	spawnLimit = scene.spawnLimit;
+
+	if (rewind) {
+		rewind->clear();
+		oldestRewindFrame = 0;
+		newestRewindFrame = 0;
+	}
+}
+
+size_t PhysicsWorld::getNumObjects() {
+	return objects.size();
+}
+
+PhysicsWorld::ObjectHandle PhysicsWorld::addObject(PhysicsObject* obj) {
+	objects.push_back(obj);
+	endSpawn({ objects.size() - 1, 1, 0, 0 }, nullptr);
+	return obj->handle;
+}
+
+PhysicsWorld::SpawnBatch PhysicsWorld::beginSpawn(size_t count) {
+	SpawnBatch batch = { objects.size(), count, nextID, objCount };
+	nextID += static_cast<uint32_t>(count);
+	objCount += static_cast<uint32_t>(count);
+	objects.resize(objects.size() + count);
+	handleSlots.reserve(handleSlots.size() + count);
+	return batch;
+}
+
+void PhysicsWorld::initSpawned(const SpawnBatch& batch, const ParticleArrays& particles, size_t low, size_t high) {
+	for (size_t i = low; i < high; i++) {
+		float radius = particles.radii.empty() ? OBJECT_SIZE : particles.radii[i];
+		objects[batch.first + i] = new PhysicsObject(this, particles.positions[i], radius, particles.velocities[i],
+			batch.firstID + static_cast<uint32_t>(i), batch.firstColor + static_cast<uint32_t>(i));
+	}
+}
+
+// hands out slots from the free list first, handles may be null when the caller keeps none
+void PhysicsWorld::endSpawn(const SpawnBatch& batch, ObjectHandle* handles) {
+	for (size_t i = 0; i < batch.count; i++) {
+		uint32_t slot = freeHandleSlot;
+		if (slot != UINT32_MAX) freeHandleSlot = handleSlots[slot].denseIndex;
+		else {
+			slot = static_cast<uint32_t>(handleSlots.size());
+			handleSlots.push_back({ 0, 0 });
+		}
+
+		PhysicsObject* obj = objects[batch.first + i];
+		handleSlots[slot].denseIndex = static_cast<uint32_t>(batch.first + i);
+		obj->handle = { slot, handleSlots[slot].generation };
+		if (handles) handles[i] = obj->handle;
+	}
+	objectsAdded += batch.count;
+	addToBroadPhase(batch.first, batch.count);
+}
+
+size_t PhysicsWorld::addObjects(ParticleArrays& particles) {
+	SpawnBatch batch = beginSpawn(particles.size());
+	initSpawned(batch, particles, 0, batch.count);
+	particles.handles.resize(batch.count);
+	endSpawn(batch, particles.handles.data());
+	return batch.count;
+}
+
+PhysicsWorld::PhysicsObject* PhysicsWorld::getObject(ObjectHandle handle) {
+	if (handle.index >= handleSlots.size() || handleSlots[handle.index].generation != handle.generation) return nullptr;
+	return objects[handleSlots[handle.index].denseIndex];
+}
+
+// Swaps the last object into the hole so the dense list stays packed. Broad phases rebuild from the
+// object list before they read their cells, so the grid is left alone here.
+bool PhysicsWorld::destroyObject(ObjectHandle handle) {
+	PhysicsObject* obj = getObject(handle);
+	if (!obj) return false;
+	removeFromBroadPhase(obj);
+
+	HandleSlot& slot = handleSlots[handle.index];
+	PhysicsObject* last = objects.back();
+	objects[slot.denseIndex] = last;
+	handleSlots[last->handle.index].denseIndex = slot.denseIndex;
+	objects.pop_back();
+
+	slot.generation++;
+	slot.denseIndex = freeHandleSlot;
+	freeHandleSlot = handle.index;
+	objectsDestroyed++;
+
+	delete obj;
+	return true;
+}
+
+size_t PhysicsWorld::destroyObjects(const std::vector<ObjectHandle>& handles) {
+	size_t destroyed = 0;
+	for (ObjectHandle handle : handles) destroyed += destroyObject(handle);
+	return destroyed;
+}
+
+
+void PhysicsWorld::stopSpawners() {
+	for (auto spawner : spawners) spawner->stop();
+}
+
+void PhysicsWorld::startSpawners() {
+	for (auto spawner : spawners) spawner->start();
+}
+
+void PhysicsWorld::updateSpawners(float dt) {
+	if (objects.size() + pendingSpawns.size() >= spawnLimit) { stopSpawners(); }
+	for (auto spawner : spawners) {
+		spawner->update(dt);
+	}
+}
+
+bool PhysicsWorld::spawnObject(glm::vec2 position, glm::vec2 velocity) {
+	return spawnObject(position, velocity, OBJECT_SIZE);
+}
+
+bool PhysicsWorld::spawnObject(glm::vec2 position, glm::vec2 velocity, float radius) {
+	return commands->push({ PhysicsCommand::SPAWN, ObjectHandle(), position, velocity, radius });
+}
+
+bool PhysicsWorld::removeObject(ObjectHandle handle) {
+	return commands->push({ PhysicsCommand::REMOVE, handle, glm::vec2(0), glm::vec2(0), 0.f });
+}
+
+bool PhysicsWorld::applyImpulse(ObjectHandle handle, glm::vec2 impulse) {
+	return commands->push({ PhysicsCommand::IMPULSE, handle, glm::vec2(0), impulse, 0.f });
+}
+
+PhysicsWorld::CommandStats PhysicsWorld::getCommandStats() const {
+	return { commands->pushed(), commands->rejected(), commandsApplied, commands->capacity() };
+}
+
+// Takes at most one queue's worth of commands per call so producers that keep pushing can't stall the frame.
+// Commands on handles that have gone stale are dropped.
+void PhysicsWorld::applyCommands() {
+	commandsApplied += commands->drain([&](const PhysicsCommand& command) {
+		PhysicsObject* obj;
+		switch (command.type) {
+		case PhysicsCommand::SPAWN:
+			pendingSpawns.push(command.position, command.vector, command.radius);
+			break;
+		case PhysicsCommand::REMOVE:
+			destroyObject(command.handle);
+			break;
+		case PhysicsCommand::IMPULSE:
+			obj = getObject(command.handle);
+			if (!obj) break;
+			obj->velocity += command.vector / obj->mass;
+			objectsPushed++;
+			break;
+		}
+	}, commands->capacity());
+}
+
+void PhysicsWorld::setCompactSnapshots(bool enabled) {
+	compactSnapshots = enabled;
+}
+
+void PhysicsWorld::publishSnapshot() {
+	framesSimulated++;
+	publishRenderSnapshot();
+	if (sharedFrames) publishSharedFrame();
+	if (trajectory) recordTrajectoryFrame();
+	if (rewind) captureRewindFrame();
+}
+
+void PhysicsWorld::publishRenderSnapshot() {
+	RenderSnapshot& snapshot = snapshots->getBack();
+	bool compact = compactSnapshots;
+	if (compact) {
+		snapshot.objects.clear();
+		snapshot.compact.clear();
+		snapshot.compact.setCellSize(CELL_SIZE);
+		for (PhysicsObject* obj : objects) {
+			if (snapshot.compact.push(obj->position, obj->velocity, obj->radius, obj->mass, obj->id)) continue;
+			// more kinds of object than the species table holds, so this frame goes out in full
+			compact = false;
+			break;
+		}
+	}
+	if (!compact) {
+		snapshot.compact.clear();
+		snapshot.objects.resize(objects.size());
+		for (size_t i = 0; i < objects.size(); i++) {
+			snapshot.objects[i] = { objects[i]->handle, objects[i]->position, objects[i]->radius, objects[i]->color };
+		}
+	}
+	binSnapshot(snapshot);
+	snapshot.frame = framesSimulated;
+	snapshot.metrics = metrics;
+	snapshots->publish();
+}
+
+// A counting sort: cells count their objects, take their end in grid.objects, and walking the objects
+// backwards leaves every cell's first at its start with its objects in snapshot order. A compact snapshot
+// is binned in CELL_SIZE cells already, so its particles are streamed instead of the objects.
+// The cells stay allocated between frames and only the ones this buffer's last binning occupied are
+// cleared, so the work follows the objects rather than the world's area.
+void PhysicsWorld::binSnapshot(RenderSnapshot& snapshot) const {
+	RenderGrid& grid = snapshot.grid;
+	uint32_t columns = (simulationWidth + CELL_SIZE - 1) / CELL_SIZE;
+	uint32_t rows = (simulationHeight + CELL_SIZE - 1) / CELL_SIZE;
+	if (grid.columns != columns || grid.rows != rows || grid.cellSize != CELL_SIZE) {
+		grid.cellSize = CELL_SIZE;
+		grid.columns = columns;
+		grid.rows = rows;
+		grid.cells.assign(static_cast<size_t>(columns) * rows, RenderCell());
+	}
+	else {
+		for (uint32_t c : grid.occupied) grid.cells[c] = RenderCell();
+	}
+	grid.occupied.clear();
+	grid.objects.resize(objects.size());
+
+	// compact particles take their colour from their id, so their cells have to be averaged the same way
+	bool compact = snapshot.compact.size() > 0;
+	auto cellOf = [&](size_t i) {
+		if (compact) {
+			glm::uvec2 cell = glm::min(snapshot.compact.getCell(i), glm::uvec2(grid.columns - 1, grid.rows - 1));
+			return static_cast<size_t>(cell.y) * grid.columns + cell.x;
+		}
+		int x = std::clamp(static_cast<int>(floorf(objects[i]->position.x / CELL_SIZE)), 0, static_cast<int>(grid.columns) - 1);
+		int y = std::clamp(static_cast<int>(floorf(objects[i]->position.y / CELL_SIZE)), 0, static_cast<int>(grid.rows) - 1);
+		return static_cast<size_t>(y) * grid.columns + x;
+	};
+	// the occupied cells take their ranges in the order they were first seen, which a view never relies on
+	for (size_t i = 0; i < objects.size(); i++) {
+		size_t c = cellOf(i);
+		if (!grid.cells[c].count++) grid.occupied.push_back(static_cast<uint32_t>(c));
+	}
+	uint32_t end = 0;
+	for (uint32_t c : grid.occupied) {
+		end += grid.cells[c].count;
+		grid.cells[c].first = end;
+	}
+	for (size_t i = objects.size(); i--;) grid.objects[--grid.cells[cellOf(i)].first] = static_cast<uint32_t>(i);
+
+	float cellArea = static_cast<float>(CELL_SIZE * CELL_SIZE);
+	for (uint32_t c : grid.occupied) {
+		RenderCell& cell = grid.cells[c];
+		uint32_t channels[4] = {};
+		float area = 0.f;
+		for (uint32_t k = cell.first; k < cell.first + cell.count; k++) {
+			uint32_t i = grid.objects[k];
+			uint32_t color = compact ? snapshot.compact.getColor(i) : objects[i]->color;
+			for (int c = 0; c < 4; c++) channels[c] += (color >> (8 * c)) & 0xff;
+			float radius = compact ? snapshot.compact.getSpecies(i).radius : objects[i]->radius;
+			area += radius * radius;
+		}
+		for (int c = 0; c < 4; c++) cell.color |= (channels[c] / cell.count) << (8 * c);
+		cell.coverage = area * PI / cellArea;
+	}
+}
+
+void PhysicsWorld::publishSharedFrame() {
+	SharedFrameRing::Arrays arrays = sharedFrames->beginWrite(framesSimulated);
+	uint32_t count = static_cast<uint32_t>(std::min<size_t>(objects.size(), sharedFrames->getHeader().capacity));
+	for (uint32_t i = 0; i < count; i++) {
+		const PhysicsObject* obj = objects[i];
+		arrays.positions[2 * i] = obj->position.x;
+		arrays.positions[2 * i + 1] = obj->position.y;
+		arrays.velocities[2 * i] = obj->velocity.x;
+		arrays.velocities[2 * i + 1] = obj->velocity.y;
+		arrays.radii[i] = obj->radius;
+		arrays.colors[i] = obj->color;
+		arrays.ids[i] = obj->id;
+	}
+	sharedFrames->endWrite(count, static_cast<uint32_t>(objects.size()));
+}
+
+// only the copy happens here, the recorder thread does the encoding and writing
+void PhysicsWorld::recordTrajectoryFrame() {
+	TrajectoryFrame& frame = trajectory->beginFrame();
+	frame.frame = framesSimulated;
+	frame.ids.resize(objects.size());
+	frame.positions.resize(objects.size());
+	for (size_t i = 0; i < objects.size(); i++) {
+		frame.ids[i] = objects[i]->id;
+		frame.positions[i] = objects[i]->position;
+	}
+	trajectory->endFrame();
+}
+
+void PhysicsWorld::captureRewindFrame() {
+	rewindState.frame = framesSimulated;
+	rewindState.objects.resize(objects.size());
+	for (size_t i = 0; i < objects.size(); i++) {
+		const PhysicsObject* obj = objects[i];
+		rewindState.objects[i] = { obj->id, obj->handle.index, obj->color, obj->radius, obj->position, obj->velocity };
+	}
+	rewindState.slots.resize(2 * handleSlots.size());
+	for (size_t i = 0; i < handleSlots.size(); i++) {
+		rewindState.slots[2 * i] = handleSlots[i].denseIndex;
+		rewindState.slots[2 * i + 1] = handleSlots[i].generation;
+	}
+	rewindState.freeHandleSlot = freeHandleSlot;
+	rewindState.nextID = nextID;
+	rewindState.objectCount = objCount;
+	rewindState.spawnerClocks.resize(spawners.size());
+	rewindState.spawnersShooting.resize(spawners.size());
+	for (size_t i = 0; i < spawners.size(); i++) {
+		rewindState.spawnerClocks[i] = spawners[i]->getClock();
+		rewindState.spawnersShooting[i] = spawners[i]->isShooting();
+	}
+
+	rewind->capture(rewindState);
+	oldestRewindFrame = rewind->getOldestFrame();
+	newestRewindFrame = rewind->getNewestFrame();
+}
+
+void PhysicsWorld::beginFrameMetrics() {
+	metrics = FrameMetrics();
+	counters.pairTests = 0;
+	counters.contacts = 0;
+	counters.eventsProcessed = 0;
+	counters.eventsDiscarded = 0;
+	counters.listBuilds = 0;
+	poolStatsAtFrameStart = pool->getStats();
+	addedAtFrameStart = objectsAdded;
+	destroyedAtFrameStart = objectsDestroyed;
+}
+
+// the broad phase has already filled in the cell occupancy
+void PhysicsWorld::endFrameMetrics(float frameMillis) {
+	ThreadPool::Stats poolStats = pool->getStats();
+
+	metrics.frame = framesSimulated + 1;
+	metrics.frameMillis = frameMillis;
+	metrics.objects = static_cast<uint32_t>(objects.size());
+	for (PhysicsObject* obj : objects) {
+		if (obj->velocity == glm::vec2(0)) metrics.objectsResting++;
+		else metrics.objectsMoving++;
+	}
+	metrics.objectsSpawned = static_cast<uint32_t>(objectsAdded - addedAtFrameStart);
+	metrics.objectsDestroyed = static_cast<uint32_t>(objectsDestroyed - destroyedAtFrameStart);
+
+	metrics.pairTests = counters.pairTests;
+	metrics.contacts = counters.contacts;
+	metrics.eventsProcessed = counters.eventsProcessed;
+	metrics.eventsDiscarded = counters.eventsDiscarded;
+	metrics.listBuilds = counters.listBuilds;
+
+	metrics.tasksRun = poolStats.tasksCompleted - poolStatsAtFrameStart.tasksCompleted;
+	metrics.taskWaitMillis = (poolStats.waitNanos - poolStatsAtFrameStart.waitNanos) / 1e6f;
+	metrics.taskBusyMillis = (poolStats.busyNanos - poolStatsAtFrameStart.busyNanos) / 1e6f;
+
+	if (metricsInterval && metrics.frame % metricsInterval == 0) writeMetrics();
+}
+
+const PhysicsWorld::FrameMetrics& PhysicsWorld::getFrameMetrics() const {
+	return metrics;
+}
+
+void PhysicsWorld::exportMetrics(const std::string& path, uint32_t interval) {
+	metricsPath = path;
+	metricsInterval = interval;
+}
+
+bool PhysicsWorld::exportSharedFrames(const std::string& name, uint32_t slots, uint32_t capacity) {
+	delete sharedFrames;
+	sharedFrames = 0;
+	if (name.empty()) return true;
+	sharedFrames = SharedFrameRing::create(name, slots, capacity);
+	return sharedFrames != 0;
+}
+
+const SharedFrameRing* PhysicsWorld::getSharedFrames() const {
+	return sharedFrames;
+}
+
+bool PhysicsWorld::recordTrajectory(const std::string& path, float quantum, uint32_t keyframeInterval) {
+	delete trajectory;
+	trajectory = 0;
+	if (path.empty()) return true;
+	trajectory = TrajectoryRecorder::create(path, quantum, keyframeInterval);
+	return trajectory != 0;
+}
+
+const TrajectoryRecorder* PhysicsWorld::getTrajectoryRecorder() const {
+	return trajectory;
+}
+
+void PhysicsWorld::keepRewindHistory(uint32_t frames, uint32_t keyframeInterval) {
+	delete rewind;
+	rewind = frames ? new RewindBuffer(frames, keyframeInterval) : 0;
+	oldestRewindFrame = 0;
+	newestRewindFrame = 0;
+}
+
+const RewindBuffer* PhysicsWorld::getRewindBuffer() const {
+	return rewind;
+}
+
+// The objects are built anew in the order they were held, with their ids, colours and handles. The old ones
+// leave the broad phase as destroyed ones do, the new ones are linked in as spawned ones are, and bumping
+// both counters renumbers any broad phase that keeps places in objects.
+bool PhysicsWorld::restoreFrame(uint64_t frame) {
+	if (!rewind || !rewind->restore(frame, rewindState)) return false;
+
+	for (PhysicsObject* obj : objects) {
+		removeFromBroadPhase(obj);
+		delete obj;
+	}
+	objects.resize(rewindState.objects.size());
+	handleSlots.resize(rewindState.slots.size() / 2);
+	for (size_t i = 0; i < handleSlots.size(); i++) handleSlots[i] = { rewindState.slots[2 * i], rewindState.slots[2 * i + 1] };
+	for (size_t i = 0; i < objects.size(); i++) {
+		const RewindState::Object& saved = rewindState.objects[i];
+		PhysicsObject* obj = new PhysicsObject(this, saved.position, saved.radius, saved.velocity, saved.id, 0);
+		obj->color = saved.color;
+		obj->handle = { saved.slot, handleSlots[saved.slot].generation };
+		objects[i] = obj;
+	}
+	freeHandleSlot = rewindState.freeHandleSlot;
+	nextID = rewindState.nextID;
+	objCount = rewindState.objectCount;
+	for (size_t i = 0; i < spawners.size() && i < rewindState.spawnerClocks.size(); i++) {
+		spawners[i]->restore(rewindState.spawnerClocks[i], rewindState.spawnersShooting[i]);
+	}
+	pendingSpawns.clear();
+	addToBroadPhase(0, objects.size());
+	objectsAdded++;
+	objectsDestroyed++;
+
+	framesSimulated = frame;
+	publishRenderSnapshot();
+	return true;
+}
+
+bool PhysicsWorld::takeRewindRequest() {
+	uint64_t frame = rewindRequest.exchange(0);
+	if (frame) restoreFrame(frame);
+	return !paused;
+}
+
+uint64_t PhysicsWorld::getOldestRewindFrame() const {
+	return oldestRewindFrame;
+}
+
+uint64_t PhysicsWorld::getNewestRewindFrame() const {
+	return newestRewindFrame;
+}
+
+void PhysicsWorld::requestRewind(uint64_t frame) {
+	rewindRequest = frame;
+}
+
+void PhysicsWorld::setPaused(bool pause) {
+	paused = pause;
+}
+
+bool PhysicsWorld::isPaused() const {
+	return paused;
+}
+
+void PhysicsWorld::exportTrace(const std::string& path, uint32_t frames) {
+	tracePath = path;
+	traceFrames = frames;
+}
+
+const std::string& PhysicsWorld::getTracePath() const {
+	return tracePath;
+}
+
+uint32_t PhysicsWorld::getTraceFrames() const {
+	return traceFrames;
+}
+
+void PhysicsWorld::captureTrace() {
+	if (!tracePath.empty()) Tracer::capture(tracePath, traceFrames);
+}
+
+// written next to the target and renamed over it, so a scraper never reads half a file
+void PhysicsWorld::writeMetrics() const {
+	std::string temporaryPath = metricsPath + ".tmp";
+	std::ofstream file(temporaryPath, std::ios::trunc);
+	if (!file) return;
+
+	file << "# TYPE atomos_frame counter\natomos_frame " << metrics.frame << "\n";
+	file << "# TYPE atomos_frame_milliseconds gauge\natomos_frame_milliseconds " << metrics.frameMillis << "\n";
+	file << "# TYPE atomos_objects gauge\n";
+	file << "atomos_objects{state=\"moving\"} " << metrics.objectsMoving << "\n";
+	file << "atomos_objects{state=\"resting\"} " << metrics.objectsResting << "\n";
+	file << "# TYPE atomos_objects_spawned gauge\natomos_objects_spawned " << metrics.objectsSpawned << "\n";
+	file << "# TYPE atomos_objects_destroyed gauge\natomos_objects_destroyed " << metrics.objectsDestroyed << "\n";
+	file << "# TYPE atomos_substeps gauge\natomos_substeps " << metrics.substeps << "\n";
+	file << "# TYPE atomos_max_speed gauge\natomos_max_speed " << metrics.maxSpeed << "\n";
+	file << "# TYPE atomos_pair_tests gauge\natomos_pair_tests " << metrics.pairTests << "\n";
+	file << "# TYPE atomos_contacts gauge\natomos_contacts " << metrics.contacts << "\n";
+	file << "# TYPE atomos_events gauge\n";
+	file << "atomos_events{outcome=\"processed\"} " << metrics.eventsProcessed << "\n";
+	file << "atomos_events{outcome=\"discarded\"} " << metrics.eventsDiscarded << "\n";
+	file << "# TYPE atomos_neighbour_list_builds gauge\natomos_neighbour_list_builds " << metrics.listBuilds << "\n";
+	file << "# TYPE atomos_occupied_cells gauge\natomos_occupied_cells " << metrics.occupiedCells << "\n";
+	file << "# TYPE atomos_max_objects_per_cell gauge\natomos_max_objects_per_cell " << metrics.maxObjectsPerCell << "\n";
+	file << "# TYPE atomos_cell_occupancy gauge\n";
+	for (int i = 0; i < OCCUPANCY_BUCKETS; i++) {
+		file << "atomos_cell_occupancy{objects=\"" << i + 1 << (i == OCCUPANCY_BUCKETS - 1 ? "+" : "") << "\"} " << metrics.cellOccupancy[i] << "\n";
+	}
+	file << "# TYPE atomos_pool_tasks gauge\natomos_pool_tasks " << metrics.tasksRun << "\n";
+	file << "# TYPE atomos_pool_wait_milliseconds gauge\natomos_pool_wait_milliseconds " << metrics.taskWaitMillis << "\n";
+	file << "# TYPE atomos_pool_busy_milliseconds gauge\natomos_pool_busy_milliseconds " << metrics.taskBusyMillis << "\n";
+	file.close();
+
+	std::remove(metricsPath.c_str());
+	std::rename(temporaryPath.c_str(), metricsPath.c_str());
+}
+
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+PhysicsController<BroadPhase, NarrowPhase, Scheduler>::PhysicsController(uint32_t simulationWidth_, uint32_t simulationHeight_) :
+	PhysicsWorld(simulationWidth_, simulationHeight_), broadPhase(simulationWidth_, simulationHeight_) {
+	if (DEFAULT_THREAD_PLACEMENT != CpuTopology::UNPINNED) setThreadPlacement(DEFAULT_THREAD_PLACEMENT);
+}
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+void PhysicsController<BroadPhase, NarrowPhase, Scheduler>::update(float dt) {
+	if (!takeRewindRequest()) return;
+	dt = fmin(dt, maxTimeStep<NarrowPhase>);
+	Timer frameTimer;
+	frameTimer.start();
+	Tracer::beginFrame();
+	beginFrameMetrics();
+
+	{
+		Tracer::Scope stage("commands");
+		applyCommands();
+	}
+	{
+		Tracer::Scope stage("spawners");
+		updateSpawners(dt);
+		spawnObjects(pendingSpawns);
+		pendingSpawns.clear();
+	}
+	{
+		Tracer::Scope stage("narrow phase");
+		uint32_t substeps = chooseSubsteps(dt);
+		for (uint32_t i = 0; i < substeps; i++) narrowPhase.step(*this, dt / substeps);
+	}
+	{
+		Tracer::Scope stage("metrics");
+		broadPhase.collectOccupancy(*this, metrics);
+		endFrameMetrics(frameTimer.readSplitMillis());
+	}
+	{
+		Tracer::Scope stage("snapshot");
+		publishSnapshot();
+	}
+	Tracer::endFrame();
+}
+
+
+// Speeds are taken as they will be at the end of the step, before any contact slows them, and capped at
+// MAX_SPEED so a single runaway object cannot stall the frame. Narrow phases that resolve every crossing
+// as an event always take one step and only report the speed.
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+uint32_t PhysicsController<BroadPhase, NarrowPhase, Scheduler>::chooseSubsteps(float dt) {
+	if constexpr (requires { narrowPhase.chooseSubsteps(*this, dt); }) {
+		metrics.substeps = narrowPhase.chooseSubsteps(*this, dt);
+		return metrics.substeps;
+	}
+	std::atomic<float> maxSpeed = 0.f;
+	std::atomic<float> maxRate = 0.f;
+	auto raise = [](std::atomic<float>& shared, float value) {
+		float seen = shared.load(std::memory_order_relaxed);
+		while (value > seen && !shared.compare_exchange_weak(seen, value, std::memory_order_relaxed));
+	};
+	scheduler.parallelFor(pool, 0, static_cast<int>(objects.size()), [&](int low, int high) {
+		float bandSpeed = 0.f;
+		float bandRate = 0.f;
+		for (int i = low; i < high; i++) {
+			float speed = fmin(glm::length(objects[i]->velocity) + GRAVITATIONAL_FORCE * dt, MAX_SPEED);
+			bandSpeed = fmax(bandSpeed, speed);
+			bandRate = fmax(bandRate, speed / objects[i]->radius);
+		}
+		raise(maxSpeed, bandSpeed);
+		raise(maxRate, bandRate);
+	});
+
+	metrics.maxSpeed = maxSpeed;
+	if constexpr (NarrowPhase::usesSubsteps) {
+		float substeps = ceilf(maxRate * dt / CFL_FRACTION);
+		metrics.substeps = static_cast<uint32_t>(std::clamp(substeps, 1.f, static_cast<float>(MAX_SUBSTEPS)));
+	}
+	return metrics.substeps;
+}
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+size_t PhysicsController<BroadPhase, NarrowPhase, Scheduler>::spawnObjects(ParticleArrays& particles) {
+	SpawnBatch batch = beginSpawn(particles.size());
+	if (batch.count < PARALLEL_SPAWN_MINIMUM) initSpawned(batch, particles, 0, batch.count);
+	else scheduler.parallelFor(pool, 0, static_cast<int>(batch.count), [&](int low, int high) {
+		initSpawned(batch, particles, low, high);
+	});
+	particles.handles.resize(batch.count);
+	endSpawn(batch, particles.handles.data());
+	return batch.count;
+}
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+bool PhysicsController<BroadPhase, NarrowPhase, Scheduler>::setThreadPlacement(CpuTopology::Placement placement) {
+	bool pinned = pool->pin(placement);
+	broadPhase.placeMemory(*this);
+	return pinned;
+}
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+void PhysicsController<BroadPhase, NarrowPhase, Scheduler>::removeFromBroadPhase(PhysicsObject* obj) {
+	broadPhase.remove(*this, obj);
+}
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+void PhysicsController<BroadPhase, NarrowPhase, Scheduler>::addToBroadPhase(size_t first, size_t count) {
+	broadPhase.add(*this, first, count);
+}
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+bool PhysicsController<BroadPhase, NarrowPhase, Scheduler>::setThreadCount(uint32_t threads) {
+	CpuTopology::Placement placement = pool->getPlacement();
+	delete pool;
+	pool = new ThreadPool(std::max(threads, 1u));
+	return placement == CpuTopology::UNPINNED || setThreadPlacement(placement);
+}
+
+
+const PhysicsWorld::RenderSnapshot& PhysicsWorld::readSnapshot() {
+	snapshots->acquire();
+	return snapshots->getFront();
+}
+
+uint32_t PhysicsWorld::getWidth() const {
+	return simulationWidth;
+}
+
+uint32_t PhysicsWorld::getHeight() const {
+	return simulationHeight;
+}
+
+void PhysicsWorld::readParticles(ParticleArrays& particles) const {
+	particles.handles.resize(objects.size());
+	particles.positions.resize(objects.size());
+	particles.velocities.resize(objects.size());
+	particles.radii.resize(objects.size());
+	for (size_t i = 0; i < objects.size(); i++) {
+		particles.handles[i] = objects[i]->handle;
+		particles.positions[i] = objects[i]->position;
+		particles.velocities[i] = objects[i]->velocity;
+		particles.radii[i] = objects[i]->radius;
+	}
+}
+
+size_t PhysicsWorld::queryObjects(glm::vec2 low, glm::vec2 high, std::vector<ObjectHandle>& found) const {
+	size_t before = found.size();
+	for (PhysicsObject* obj : objects) {
+		if (obj->position.x >= low.x && obj->position.y >= low.y && obj->position.x < high.x && obj->position.y < high.y) found.push_back(obj->handle);
+	}
+	return found.size() - before;
+}
+
+
+template class PhysicsController<UniformGridBroadPhase, ContinuousNarrowPhase, ThreadedScheduler>;
+template class PhysicsController<UniformGridBroadPhase, ContinuousNarrowPhase, SerialScheduler>;
+template class PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+template class PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, SerialScheduler>;
+template class PhysicsController<BruteForceBroadPhase, DiscreteNarrowPhase, SerialScheduler>;
+template class PhysicsController<SpatialHashBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+template class PhysicsController<NeighbourListBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+template class PhysicsController<NeighbourListBroadPhase, SpeculativeNarrowPhase, ThreadedScheduler>;
+template class PhysicsController<UniformGridBroadPhase, FixedPointNarrowPhase<Q16_16>, SerialScheduler>;
+template class PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, DeterministicScheduler>;
+template size_t ContinuousNarrowPhase::predictEvents(ContinuousPhysicsController& controller, float dt);
+template size_t ContinuousNarrowPhase::predictEvents(ContinuousSerialPhysicsController& controller, float dt);
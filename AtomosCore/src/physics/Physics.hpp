@@ -0,0 +1,782 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <glm.hpp>
+#include <array>
+#include <concepts>
+#include <string>
+#include <atomic>
+#include "ThreadPool.hpp"
+#include "CpuTopology.hpp"
+#include "SharedFrameRing.hpp"
+#include "TrajectoryRecorder.hpp"
+#include "GridContainer.hpp"
+#include "SpatialHash.hpp"
+#include "CommandQueue.hpp"
+#include "TripleBuffer.hpp"
+#include "CompactParticles.hpp"
+#include "FixedPoint.hpp"
+#include "RewindBuffer.hpp"
+#include "Scene.hpp"
+
+constexpr float REFRACTORY_TIME = .115f;
+constexpr int THREAD_COUNT = 4;
+constexpr CpuTopology::Placement DEFAULT_THREAD_PLACEMENT = CpuTopology::UNPINNED;
+constexpr float SPAWNER_EXIT_SPEED = 160.f;
+constexpr int OBJECT_SIZE = 4;
+constexpr float PI = 3.14159265f;
+
+
+// Shared simulation state. Everything that does not depend on how collisions are found, resolved
+// or scheduled lives here; the policy-specific stepping lives in PhysicsController below.
+class PhysicsWorld {
+public:
+	enum Direction {NONE = -1, UP, RIGHT, DOWN, LEFT };
+
+protected:
+	inline static uint32_t nextID = 1;
+
+	struct PhysicsComponent {
+		PhysicsWorld* controller = 0;
+		uint32_t id = nextID++;
+	};
+
+public:
+	// Stable reference to an object. The index names a slot that follows the object wherever it moves in
+	// the dense object list; the generation is bumped whenever the slot's object is destroyed, so old
+	// handles stop resolving instead of pointing at whatever took the slot next.
+	struct ObjectHandle {
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool operator==(const ObjectHandle& other) const = default;
+	};
+
+	struct PhysicsObject : PhysicsComponent {
+		glm::vec2 position;
+		glm::vec2 velocity;
+		glm::vec2 acceleration;
+
+		PhysicsObject* previous = 0;
+		PhysicsObject* next = 0;
+		glm::uvec2 cell;
+		uint32_t moverSlot = UINT32_MAX;		// where the grid queued it to be relinked, if it did
+		ObjectHandle handle;
+
+		float infrastepTime;
+		uint32_t eventStamp = 0;
+		float radius;
+		uint32_t color;
+		float mass;
+
+		PhysicsObject(PhysicsWorld* ctrlr,  glm::vec2 pos, float r, glm::vec2 v);
+		// takes its id and colour from the caller instead of the shared counters, so batches can be built in parallel
+		PhysicsObject(PhysicsWorld* ctrlr, glm::vec2 pos, float r, glm::vec2 v, uint32_t id_, uint32_t colorIndex);
+		~PhysicsObject();
+		void accelerate(glm::vec2 acc);
+		void enforceBoundaries(uint32_t width, uint32_t height);
+		void update(float timeDelta);
+		void move(float timeDelta);
+	};
+
+
+
+
+	// Cells keep their objects in an intrusive circular list threaded through PhysicsObject::previous/next
+	struct CollisionNode {
+		uint32_t numObjects = 0;
+		glm::uvec2 index;
+		glm::uvec2 minimumBound;
+		glm::uvec2 maximumBound;
+
+		PhysicsObject* head = 0;
+		PhysicsObject* tail = 0;
+
+		CollisionNode(uint32_t x, uint32_t y, uint32_t size) {
+			index = { x, y };
+			minimumBound = { x * size, y * size };
+			maximumBound = { (x + 1) * size, (y + 1) * size};
+		}
+		size_t count() const;
+		bool insert(PhysicsObject* obj);
+		// before the first object with a larger id, a cell only ever filled this way stays sorted by id
+		bool insertSorted(PhysicsObject* obj);
+		bool remove(PhysicsObject* obj);
+		void clear();
+
+		template <typename F>
+		void forEach(F&& function) {
+			PhysicsObject* current = head;
+			for (uint32_t i{ numObjects }; i--; current = current->next) function(current);
+		}
+	};
+
+
+	struct CollisionEvent {
+		enum CollisionType {ERROR, CELL_CHANGE, BOUNDARY_ENFORCEMENT, BALL_BALL};
+
+		CollisionType type;
+		float eventTime;
+		PhysicsObject* subjectObject;
+		Direction eventDirection;
+		PhysicsObject* predicateObject;
+		uint32_t subjectStamp;
+		uint32_t predicateStamp;
+
+		// std::priority_queue is a max heap, so the earliest event has to compare greatest
+		bool operator<(const CollisionEvent otherEvent) const {
+			return this->eventTime > otherEvent.eventTime;
+		}
+	};
+	typedef std::priority_queue<CollisionEvent> CollisionQueue;
+
+
+	class CollisionGrid : public GridContainer<CollisionNode> {
+	public:
+		CollisionGrid(uint32_t m, uint32_t n);
+		template <typename PairFunction> void checkCellCollisions(CollisionNode* cell1, CollisionNode* cell2, PairFunction& onPair);
+		template <typename PairFunction> void handleCollisions(int widthLow, int widthHigh, PairFunction& onPair);
+	};
+
+
+	class CollisionHash : public SpatialHash<CollisionNode> {
+	public:
+		CollisionHash();
+		// walks the occupied cells numbered cells[low..high) against their occupied neighbours
+		template <typename PairFunction> void handleCollisions(const std::vector<uint32_t>& cells, uint32_t low, uint32_t high, PairFunction& onPair);
+	};
+
+
+	// requests from other threads, applied by the simulation thread at the start of update()
+	struct PhysicsCommand {
+		enum CommandType { SPAWN, REMOVE, IMPULSE };
+
+		CommandType type;
+		ObjectHandle handle;
+		glm::vec2 position;
+		glm::vec2 vector;		// spawn velocity or impulse
+		float radius;
+	};
+
+	// what the renderer needs of each object, copied out at the end of every update
+	struct RenderObject {
+		ObjectHandle handle;
+		glm::vec2 position;
+		float radius;
+		uint32_t color;
+	};
+
+	static constexpr int OCCUPANCY_BUCKETS = 8;
+
+	// what happened during one update(), published with every snapshot
+	struct FrameMetrics {
+		uint64_t frame = 0;
+		float frameMillis = 0.f;
+
+		uint32_t objects = 0;
+		uint32_t objectsMoving = 0;
+		uint32_t objectsResting = 0;		// velocity snapped to zero
+		uint32_t objectsSpawned = 0;
+		uint32_t objectsDestroyed = 0;
+
+		uint32_t substeps = 1;				// steps the frame was cut into so nothing moves too far at once
+		float maxSpeed = 0.f;
+
+		uint64_t pairTests = 0;				// pairs the narrow phase looked at
+		uint64_t contacts = 0;				// pairs that actually touched
+		uint64_t eventsProcessed = 0;		// continuous mode only
+		uint64_t eventsDiscarded = 0;		// events made stale by a later prediction
+		uint64_t listBuilds = 0;			// neighbour list mode only
+
+		uint32_t occupiedCells = 0;
+		uint32_t maxObjectsPerCell = 0;
+		std::array<uint32_t, OCCUPANCY_BUCKETS> cellOccupancy{};		// [i] counts cells holding i + 1 objects, the last bucket holds the rest
+
+		uint64_t tasksRun = 0;
+		float taskWaitMillis = 0.f;
+		float taskBusyMillis = 0.f;
+	};
+
+	// what a view needs to draw a crowded cell as one quad instead of one circle per object
+	struct RenderCell {
+		uint32_t first = 0;			// into RenderGrid::objects
+		uint32_t count = 0;
+		uint32_t color = 0;			// mean colour of the cell's objects
+		float coverage = 0.f;		// their disc area over the cell's, past 1 when they overlap
+	};
+
+	// The snapshot's objects binned into cells of the collision grid, so a view only walks the cells it
+	// shows. Objects outside the world go to the nearest edge cell.
+	struct RenderGrid {
+		float cellSize = 0.f;
+		uint32_t columns = 0;
+		uint32_t rows = 0;
+		std::vector<RenderCell> cells;		// row by row
+		std::vector<uint32_t> objects;		// indices into objects or compact, cell by cell
+		std::vector<uint32_t> occupied;		// the cells with objects, so the next binning only clears those
+	};
+
+	// In compact mode the objects go into compact instead, at 16 bytes each, and the grid is binned from
+	// those rather than from the objects. Compact particles carry no handle and take their colour from their
+	// id. A frame with more species than compact holds goes out in full.
+	struct RenderSnapshot {
+		std::vector<RenderObject> objects;
+		CompactParticleStore compact;
+		RenderGrid grid;
+		uint64_t frame = 0;
+		FrameMetrics metrics;
+	};
+
+	// every object's state in parallel arrays, element i of each array describes the same object
+	struct ParticleArrays {
+		std::vector<ObjectHandle> handles;
+		std::vector<glm::vec2> positions;
+		std::vector<glm::vec2> velocities;
+		std::vector<float> radii;
+
+		size_t size() const { return positions.size(); }
+		void push(glm::vec2 position, glm::vec2 velocity, float radius) {
+			positions.push_back(position);
+			velocities.push_back(velocity);
+			radii.push_back(radius);
+		}
+		void clear() {
+			handles.clear();
+			positions.clear();
+			velocities.clear();
+			radii.clear();
+		}
+	};
+
+	struct CommandStats {
+		uint64_t submitted;		// accepted by the queue
+		uint64_t rejected;		// turned away because the queue was full
+		uint64_t applied;		// drained and carried out, including removes and impulses on objects that were already gone
+		size_t capacity;
+	};
+
+
+protected:
+	template <typename T>
+	class ObjectSpawner : PhysicsComponent {
+		glm::vec2 position;
+		glm::vec2 exitVelocity;
+
+		float timeSinceLastShot = REFRACTORY_TIME;
+		bool keepShooting = true;
+
+		void shoot(float age);
+	public:
+		ObjectSpawner(PhysicsWorld* ctrlr, glm::vec2 p, glm::vec2 dir, float mag);
+		void update(float timeDelta);
+		void start();
+		void stop();
+
+		// what a RewindState keeps of a spawner
+		float getClock() const { return timeSinceLastShot; }
+		bool isShooting() const { return keepShooting; }
+		void restore(float clock, bool shooting);
+	};
+	// End inner classes
+
+
+
+
+
+	// Physics World Members
+	std::vector<PhysicsObject*> objects;
+	std::vector<ObjectSpawner<PhysicsObject>*> spawners;
+	size_t spawnLimit = 0;
+	ParticleArrays pendingSpawns;		// spawner shots and spawn commands of this frame, added in one batch
+	ThreadPool* pool;
+	CommandQueue<PhysicsCommand>* commands;
+	uint64_t commandsApplied = 0;
+	TripleBuffer<RenderSnapshot>* snapshots;
+	uint64_t framesSimulated = 0;
+	std::atomic<bool> compactSnapshots = false;
+
+	// slot i holds the position in objects of the object that handles with index i refer to,
+	// free slots are chained through the same field
+	struct HandleSlot {
+		uint32_t denseIndex;
+		uint32_t generation;
+	};
+	std::vector<HandleSlot> handleSlots;
+	uint32_t freeHandleSlot = UINT32_MAX;
+	uint64_t objectsDestroyed = 0;		// lets broad phases that keep objects by their place in objects notice renumbering
+	uint64_t objectsAdded = 0;
+	uint64_t objectsPushed = 0;			// impulses applied, lets narrow phases that keep their own copy of the motion notice
+
+	// counters the policies bump during a frame, some of them from pool threads
+	struct FrameCounters {
+		std::atomic<uint64_t> pairTests = 0;
+		std::atomic<uint64_t> contacts = 0;
+		std::atomic<uint64_t> eventsProcessed = 0;
+		std::atomic<uint64_t> eventsDiscarded = 0;
+		std::atomic<uint64_t> listBuilds = 0;
+	};
+	FrameCounters counters;
+	FrameMetrics metrics;
+	ThreadPool::Stats poolStatsAtFrameStart;
+	uint64_t addedAtFrameStart;
+	uint64_t destroyedAtFrameStart;
+
+	std::string metricsPath;
+	uint32_t metricsInterval = 0;
+
+	std::string tracePath;
+	uint32_t traceFrames = 0;
+
+	SharedFrameRing* sharedFrames = 0;
+	TrajectoryRecorder* trajectory = 0;
+
+	RewindBuffer* rewind = 0;
+	RewindState rewindState;			// reused by every capture and restore
+	std::atomic<uint64_t> oldestRewindFrame = 0;
+	std::atomic<uint64_t> newestRewindFrame = 0;
+	std::atomic<uint64_t> rewindRequest = 0;
+	std::atomic<bool> paused = false;
+
+	uint32_t simulationWidth;
+	uint32_t simulationHeight;
+
+	void addSpawnerN(glm::vec2 p, glm::vec2 dir, float mag, uint32_t n);
+	ObjectHandle addObject(PhysicsObject* obj);
+	// called with every object just before it is destroyed, while it is still in objects, so a broad phase
+	// that links objects into its cells can take it out
+	virtual void removeFromBroadPhase(PhysicsObject* obj) {}
+	// called once objects [first, first + count) are in objects, so a broad phase can link them in
+	virtual void addToBroadPhase(size_t first, size_t count) {}
+
+	// A batch is added in three steps so a controller can run the middle one on its scheduler:
+	// beginSpawn makes room for count objects and hands out their ids and colours, initSpawned
+	// builds objects [low, high) of the batch without touching anything shared, and endSpawn
+	// gives them handles in order.
+	struct SpawnBatch {
+		size_t first;
+		size_t count;
+		uint32_t firstID;
+		uint32_t firstColor;
+	};
+	SpawnBatch beginSpawn(size_t count);
+	void initSpawned(const SpawnBatch& batch, const ParticleArrays& particles, size_t low, size_t high);
+	void endSpawn(const SpawnBatch& batch, ObjectHandle* handles);
+	size_t addObjects(ParticleArrays& particles);
+	void updateSpawners(float dt);
+	void applyCommands();
+	void publishSnapshot();
+	void publishRenderSnapshot();
+	void binSnapshot(RenderSnapshot& snapshot) const;
+	void publishSharedFrame();
+	void recordTrajectoryFrame();
+	void captureRewindFrame();
+	// simulation thread, carries out the rewind requested last, if any, and tells update() whether to step
+	bool takeRewindRequest();
+	void beginFrameMetrics();
+	void endFrameMetrics(float frameMillis);
+	void writeMetrics() const;
+
+	template <typename T>
+	friend class ObjectSpawner;
+
+	PhysicsWorld(uint32_t simulationWidth_, uint32_t simulationHeight_);
+	~PhysicsWorld();
+
+public:
+	size_t getNumObjects();
+	uint32_t getWidth() const;
+	uint32_t getHeight() const;
+	void stopSpawners();
+	void startSpawners();
+	// simulation thread only, destroys every object and spawner and starts over from scene with no rewind history
+	void loadScene(const Scene& scene);
+	// simulation thread only, adds a spawner that shoots objects from position along direction
+	void addSpawner(glm::vec2 position, glm::vec2 direction, float magnitude);
+
+	// the latest snapshot update() published, for one reader that may run on a different thread than
+	// update(); it stays valid until that reader calls this again
+	const RenderSnapshot& readSnapshot();
+	void setCompactSnapshots(bool enabled);
+
+	// simulation thread only, copies every object out into particles, reusing its storage
+	void readParticles(ParticleArrays& particles) const;
+	// simulation thread only, appends the objects centred inside [low, high) to found and returns how many
+	size_t queryObjects(glm::vec2 low, glm::vec2 high, std::vector<ObjectHandle>& found) const;
+
+	// safe to call from any thread, these return false when the command queue is full
+	bool spawnObject(glm::vec2 position, glm::vec2 velocity);
+	bool spawnObject(glm::vec2 position, glm::vec2 velocity, float radius);
+	bool removeObject(ObjectHandle handle);
+	bool applyImpulse(ObjectHandle handle, glm::vec2 impulse);
+	CommandStats getCommandStats() const;
+
+	// simulation thread only, all O(1) per object
+	PhysicsObject* getObject(ObjectHandle handle);
+	bool destroyObject(ObjectHandle handle);
+	size_t destroyObjects(const std::vector<ObjectHandle>& handles);
+
+	// simulation thread only, the metrics of the last finished update()
+	const FrameMetrics& getFrameMetrics() const;
+	// rewrites path every interval frames with the latest metrics, one "name{labels} value" per line
+	// in the Prometheus text format; an interval of 0 stops the export
+	void exportMetrics(const std::string& path, uint32_t interval);
+
+	// where captureTrace() and the trace button of the metrics panel write a Chrome trace of the next frames
+	void exportTrace(const std::string& path, uint32_t frames);
+	const std::string& getTracePath() const;
+	uint32_t getTraceFrames() const;
+	// safe from any thread
+	void captureTrace();
+
+	// Also writes every frame's positions, velocities, radii, colours and ids into the shared memory ring
+	// name, slots frames deep and capacity objects wide, for other processes to map with
+	// SharedFrameRing::open. An empty name stops the export. False if the ring could not be created.
+	bool exportSharedFrames(const std::string& name, uint32_t slots, uint32_t capacity);
+	const SharedFrameRing* getSharedFrames() const;
+
+	// Streams the id and position of every object to path each frame, see TrajectoryRecorder; positions are
+	// rounded to quantum and every keyframeInterval-th frame is a keyframe. An empty path finishes the file
+	// being recorded. False if path could not be opened.
+	bool recordTrajectory(const std::string& path, float quantum, uint32_t keyframeInterval);
+	const TrajectoryRecorder* getTrajectoryRecorder() const;
+
+	// Keeps the last frames frames in memory so the world can be put back to any of them, see RewindBuffer;
+	// every keyframeInterval-th is kept whole. 0 frames stops keeping them. Simulation thread only.
+	void keepRewindHistory(uint32_t frames, uint32_t keyframeInterval);
+	const RewindBuffer* getRewindBuffer() const;
+	// Simulation thread only. Puts every object, handle and spawner back as they were at the end of frame,
+	// publishes that frame and carries on from it; the frames after it stay until the next one is captured,
+	// so a scrubber can go forward again. Broad phases relink every object rather than restoring their
+	// cells, so a narrow phase that resolves contacts in cell order may take a different path from there
+	// than it did the first time; the continuous one replays bit for bit, as does anything run on a
+	// DeterministicScheduler. False if frame is not held.
+	bool restoreFrame(uint64_t frame);
+
+	// safe from any thread: the frames held, 0 while there are none
+	uint64_t getOldestRewindFrame() const;
+	uint64_t getNewestRewindFrame() const;
+	// safe from any thread, the next update() restores frame before doing anything else
+	void requestRewind(uint64_t frame);
+	// safe from any thread, a paused world still carries out rewinds but does not step
+	void setPaused(bool pause);
+	bool isPaused() const;
+};
+
+
+
+
+// Policies
+// A PhysicsController is assembled from one broad phase (which pairs of objects are worth testing),
+// one narrow phase (how the frame is integrated and contacts resolved) and one scheduler (where the
+// broad phase work runs). All dispatch between them is static.
+
+template <typename T>
+concept SchedulerPolicy = std::default_initializable<T> && requires (T scheduler, ThreadPool* pool, void (*task)(int, int)) {
+	scheduler.parallelFor(pool, 0, 0, task);
+	{ T::canonicalOrder } -> std::convertible_to<bool>;
+};
+
+template <typename T>
+concept BroadPhasePolicy = std::constructible_from<T, uint32_t, uint32_t> && requires {
+	{ T::usesGrid } -> std::convertible_to<bool>;
+};
+
+template <typename T, typename BroadPhase>
+concept NarrowPhasePolicy = std::default_initializable<T> && requires {
+	{ T::requiresGrid } -> std::convertible_to<bool>;
+	{ T::usesSubsteps } -> std::convertible_to<bool>;
+} && (!T::requiresGrid || BroadPhase::usesGrid);
+
+
+// A scheduler with canonicalOrder asks the broad phases to hand out pairs in an order that depends only on
+// the objects and their order, rather than on what the broad phase kept from earlier steps.
+
+// runs the whole range on the calling thread
+struct SerialScheduler {
+	static constexpr bool canonicalOrder = false;
+	template <typename F> void parallelFor(ThreadPool* pool, int low, int high, F&& function);
+};
+
+// splits the range into THREAD_COUNT contiguous bands and waits for all of them, band i always runs on pool worker i
+struct ThreadedScheduler {
+	static constexpr bool canonicalOrder = false;
+	template <typename F> void parallelFor(ThreadPool* pool, int low, int high, F&& function);
+};
+
+// Splits the range into the same tiles whatever the size of the pool, at most DETERMINISTIC_TILES of them
+// and none narrower than two, and runs the even tiles, waits, then runs the odd ones. A broad phase whose
+// range is rows or columns of cells only reaches the cells next to its tile, so two tiles that run at
+// the same time never touch the same object and a step comes out bit for bit the same on any pool, as
+// if the tiles had run one after another. Not for ranges whose neighbours are not next to each other,
+// like the occupied cells of a spatial hash, which sorts them into these tiles itself.
+struct DeterministicScheduler {
+	static constexpr bool canonicalOrder = true;
+	template <typename F> void parallelFor(ThreadPool* pool, int low, int high, F&& function);
+};
+
+
+// tests every object against every other object
+struct BruteForceBroadPhase {
+	static constexpr bool usesGrid = false;
+
+	BruteForceBroadPhase(uint32_t simulationWidth, uint32_t simulationHeight) {}
+	template <typename Controller> void rebuild(Controller& controller) {}
+	template <typename Controller> void lookAhead(Controller& controller, float distance) {}
+	template <typename Controller> void placeMemory(Controller& controller) {}
+	template <typename Controller> void collectOccupancy(Controller& controller, PhysicsWorld::FrameMetrics& metrics) {}
+	template <typename Controller> void remove(Controller& controller, PhysicsWorld::PhysicsObject* obj) {}
+	template <typename Controller> void add(Controller& controller, size_t first, size_t count) {}
+	template <typename Controller> void moved(Controller& controller, PhysicsWorld::PhysicsObject* obj) {}
+	template <typename Controller, typename PairFunction> void forEachPair(Controller& controller, PairFunction onPair);
+};
+
+// tests objects against the 3x3 block of CELL_SIZE cells around them.
+// The grid is kept between steps and only objects whose cell changed are moved, unless too many moved.
+// Narrow phases report every object they move, so finding the ones that changed cell costs what they moved.
+struct UniformGridBroadPhase {
+	static constexpr bool usesGrid = true;
+	PhysicsWorld::CollisionGrid* grid;
+	bool relinkAll = true;			// the cells no longer hold what the objects say they are linked into
+	std::vector<PhysicsWorld::PhysicsObject*> movers;		// at least as long as objects, the first moverCount queued
+	std::atomic<size_t> moverCount = 0;
+
+	UniformGridBroadPhase(uint32_t simulationWidth, uint32_t simulationHeight);
+	~UniformGridBroadPhase();
+	template <typename Controller> void rebuild(Controller& controller);
+	template <typename Controller> void fullRebuild(Controller& controller);
+	template <typename Controller> bool link(Controller& controller, PhysicsWorld::PhysicsObject* obj);
+	// cells are fixed at CELL_SIZE, so pairs further apart than the neighbouring cells are never seen
+	template <typename Controller> void lookAhead(Controller& controller, float distance) {}
+	template <typename Controller> void placeMemory(Controller& controller);
+	// unlinks obj from its cell, O(1)
+	template <typename Controller> void remove(Controller& controller, PhysicsWorld::PhysicsObject* obj);
+	template <typename Controller> void add(Controller& controller, size_t first, size_t count);
+	// after a narrow phase moved obj, safe from pool threads as long as no two of them pass the same object
+	template <typename Controller> void moved(Controller& controller, PhysicsWorld::PhysicsObject* obj);
+	template <typename Controller, typename PairFunction> void forEachPair(Controller& controller, PairFunction onPair);
+	template <typename Controller> void collectOccupancy(Controller& controller, PhysicsWorld::FrameMetrics& metrics);
+};
+
+
+// Tests objects against the 3x3 block of CELL_SIZE cells around them, keeping only the occupied cells.
+// Hash order is not spatial order, so the occupied cells are sorted into the column tiles the
+// DeterministicScheduler cuts a dense grid into, row by row inside each, and pairs are found for the even
+// tiles, then the odd ones: tiles that run at the same time never reach the same cell, on any scheduler,
+// and pairs come in the order the deterministic grid hands them out.
+struct SpatialHashBroadPhase {
+	static constexpr bool usesGrid = false;
+	PhysicsWorld::CollisionHash* grid;
+	int columnLow, columnHigh;				// the columns a dense grid of the world walks
+	std::vector<uint32_t> tileCells;		// occupied cell numbers tile by tile
+	std::vector<uint32_t> tileStart;		// one past the last tile, where each tile begins in tileCells
+
+	SpatialHashBroadPhase(uint32_t simulationWidth, uint32_t simulationHeight);
+	~SpatialHashBroadPhase();
+	template <typename Controller> void rebuild(Controller& controller);
+	// cells are fixed at CELL_SIZE, so pairs further apart than the neighbouring cells are never seen
+	template <typename Controller> void lookAhead(Controller& controller, float distance) {}
+	// cells come and go every step and are touched by the thread that fills them, so there is nothing to place
+	template <typename Controller> void placeMemory(Controller& controller) {}
+	// the cells are refilled every step, nothing outlives it
+	template <typename Controller> void remove(Controller& controller, PhysicsWorld::PhysicsObject* obj) {}
+	template <typename Controller> void add(Controller& controller, size_t first, size_t count) {}
+	template <typename Controller> void moved(Controller& controller, PhysicsWorld::PhysicsObject* obj) {}
+	template <typename Controller, typename PairFunction> void forEachPair(Controller& controller, PairFunction onPair);
+	template <typename Controller> void collectOccupancy(Controller& controller, PhysicsWorld::FrameMetrics& metrics);
+};
+
+
+// Keeps for every object the others within the sum of their radii plus NEIGHBOUR_SKIN, in one CSR array,
+// and reuses the lists across collision iterations and frames until some object has moved more than half
+// the skin since they were built. Any spawn or destruction renumbers the objects and forces a build too.
+// The lists are built by sorting the objects into bins of twice the largest radius plus the skin.
+struct NeighbourListBroadPhase {
+	static constexpr bool usesGrid = false;
+	std::vector<uint32_t> offsets;			// the neighbours of object i are neighbours[offsets[i]] .. neighbours[offsets[i + 1] - 1]
+	std::vector<uint32_t> neighbours;
+	std::vector<glm::vec2> builtAt;			// positions at the last build
+	std::vector<uint32_t> binOf;
+	std::vector<uint32_t> binStart;			// objects of bin b are binned[binStart[b]] .. binned[binStart[b + 1] - 1]
+	std::vector<uint32_t> binned;
+	uint32_t binsWide = 0;
+	uint32_t binsHigh = 0;
+	float binSize = 0.f;
+	float reach = 0.f;						// extra distance on top of the skin that a narrow phase asked to see
+	uint64_t addedAtBuild = UINT64_MAX;
+	uint64_t destroyedAtBuild = UINT64_MAX;
+
+	NeighbourListBroadPhase(uint32_t simulationWidth, uint32_t simulationHeight) {}
+	template <typename Controller> void rebuild(Controller& controller);
+	template <typename Controller> void buildLists(Controller& controller);
+	// makes sure pairs up to distance apart are listed from the next rebuild on
+	template <typename Controller> void lookAhead(Controller& controller, float distance);
+	template <typename Controller, typename F> void forEachNearby(Controller& controller, uint32_t object, F&& function);
+	// lists are written by whichever worker builds them, there is nothing to place ahead of that
+	template <typename Controller> void placeMemory(Controller& controller) {}
+	// the lists hold places in objects, which a destruction renumbers, so rebuild() starts them over anyway
+	template <typename Controller> void remove(Controller& controller, PhysicsWorld::PhysicsObject* obj) {}
+	// spawns are noticed through objectsAdded and movement through builtAt
+	template <typename Controller> void add(Controller& controller, size_t first, size_t count) {}
+	template <typename Controller> void moved(Controller& controller, PhysicsWorld::PhysicsObject* obj) {}
+	template <typename Controller, typename PairFunction> void forEachPair(Controller& controller, PairFunction onPair);
+	template <typename Controller> void collectOccupancy(Controller& controller, PhysicsWorld::FrameMetrics& metrics);
+};
+
+
+// moves every object for the full step, then pushes overlapping pairs apart COLLISION_ITERATIONS times
+struct DiscreteNarrowPhase {
+	static constexpr bool requiresGrid = false;
+	static constexpr bool usesSubsteps = true;		// a fast object can jump through another within one step
+
+	static bool checkCollision(PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2, uint32_t simWidth, uint32_t simHeight);
+	template <typename Controller> void step(Controller& controller, float dt);
+};
+
+// The discrete solver on integers, Number being a Fixed such as Q16_16. Positions, velocities and radii
+// are held as raw fixed point from one frame to the next and only written out as floats for the broad
+// phase and the snapshot, so with a serial scheduler a run is bit for bit the same on any compiler, flags
+// or pool size. The substeps and their length are chosen on the integers too; the frame's dt is the one
+// float taken in, once. The world has to fit in Number's integer part. Only a frame in which objects were
+// spawned, destroyed, pushed or rewound looks at the floats again: an object whose floats are no longer
+// the ones last written out is taken back in from them.
+template <typename Number>
+class FixedPointNarrowPhase {
+	std::vector<uint32_t> ids;
+	std::vector<glm::ivec2> positions;
+	std::vector<glm::ivec2> velocities;
+	std::vector<int32_t> radii;
+	uint64_t addedAtLoad = 0;
+	uint64_t destroyedAtLoad = 0;
+	uint64_t pushedAtLoad = 0;
+	int32_t substepLength = 0;		// raw, the frame's dt split over its substeps
+
+	template <typename Controller> void load(Controller& controller);
+	void store(PhysicsWorld::PhysicsObject* obj, size_t i) const;
+	void enforceBoundaries(size_t i, int32_t width, int32_t height);
+	bool checkCollision(size_t i, size_t j, int32_t width, int32_t height);
+public:
+	static constexpr bool requiresGrid = false;
+	static constexpr bool usesSubsteps = true;
+
+	// PhysicsController::chooseSubsteps on the integers; fills in the speed metrics
+	template <typename Controller> uint32_t chooseSubsteps(Controller& controller, float dt);
+	// takes the substep length chooseSubsteps worked out rather than dt
+	template <typename Controller> void step(Controller& controller, float dt);
+};
+
+// Gives every object its full velocity for the step, then looks ahead: a pair that would close its gap
+// before the end of the step, or an object that would reach a wall, bounces at the moment of contact,
+// with the same response as the discrete solver, so nothing tunnels even at MAX_SPECULATIVE_TIME_STEP.
+// Overlaps left after moving are pushed apart once. Needs a broad phase that can look as far ahead as
+// two objects close in one step, which only the neighbour list does.
+struct SpeculativeNarrowPhase {
+	static constexpr bool requiresGrid = false;
+	static constexpr bool usesSubsteps = false;
+
+	static bool speculate(PhysicsWorld::PhysicsObject* obj1, PhysicsWorld::PhysicsObject* obj2, float dt);
+	static void speculateBoundaries(PhysicsWorld::PhysicsObject* obj, float dt, uint32_t simWidth, uint32_t simHeight);
+	template <typename Controller> void step(Controller& controller, float dt);
+};
+
+// predicts the next event of every object and advances the frame event by event.
+// The first prediction of each object runs on the scheduler, the event loop itself is serial.
+class ContinuousNarrowPhase {
+	PhysicsWorld::CollisionQueue eventQueue;
+	std::vector<PhysicsWorld::CollisionEvent> setupEvents;
+
+	template <typename Controller> bool predictCollision(Controller& controller, PhysicsWorld::PhysicsObject* object, float dt, PhysicsWorld::CollisionEvent& event);
+	template <typename Controller> void predictAll(Controller& controller, float dt);
+	template <typename Controller> void addCollisionsToQueue(Controller& controller, PhysicsWorld::PhysicsObject* object, float dt);
+	template <typename Controller> void checkCollisionsQueue(Controller& controller, float dt);
+public:
+	static constexpr bool requiresGrid = true;
+	static constexpr bool usesSubsteps = false;		// every cell crossing is an event, nothing can be jumped over
+
+	template <typename Controller> void step(Controller& controller, float dt);
+	// queues the next event of every object on the calling thread and returns how many were queued,
+	// the broad phase has to be current as it is after update()
+	template <typename Controller> size_t predictEvents(Controller& controller, float dt);
+};
+
+
+
+
+template <BroadPhasePolicy BroadPhase, typename NarrowPhase, SchedulerPolicy Scheduler>
+	requires NarrowPhasePolicy<NarrowPhase, BroadPhase>
+class PhysicsController : public PhysicsWorld {
+	BroadPhase broadPhase;
+	NarrowPhase narrowPhase;
+	Scheduler scheduler;
+
+	friend BroadPhase;
+	friend NarrowPhase;
+
+	// fastest object relative to its radius, reduced on the scheduler unless the narrow phase has a
+	// chooseSubsteps of its own; fills in the speed metrics
+	uint32_t chooseSubsteps(float dt);
+	void removeFromBroadPhase(PhysicsObject* obj) override;
+	void addToBroadPhase(size_t first, size_t count) override;
+
+public:
+	PhysicsController(uint32_t simulationWidth_, uint32_t simulationHeight_);
+	void update(float dt);
+	const BroadPhase& getBroadPhase() const { return broadPhase; }
+	NarrowPhase& getNarrowPhase() { return narrowPhase; }
+
+	// Pins the pool workers as placement says, then rebuilds the broad phase memory band by band from the
+	// worker that walks each band, the grid cells and a copy of every object in the band, so on a NUMA
+	// machine each band sits on its worker's node. Objects spawned later, or that drift into another band,
+	// stay where they are until the next call. Returns false if some worker could not be pinned;
+	// simulation thread only, and object pointers taken before it are stale after it.
+	bool setThreadPlacement(CpuTopology::Placement placement);
+	// Replaces the pool with one of threads workers, at least one, placed the way the old one was. Returns
+	// false if some worker could not be pinned; simulation thread only.
+	bool setThreadCount(uint32_t threads);
+
+	// Simulation thread only. Adds every object of particles with one reservation, builds them on the
+	// scheduler when the batch is large and writes their handles to particles.handles. Empty radii spawn
+	// OBJECT_SIZE objects. The broad phase links the whole batch into its grid on the next step.
+	size_t spawnObjects(ParticleArrays& particles);
+	// simulation thread only, spawns the Scene::Body that generate(i) returns for every i in [0, count), in order
+	template <typename Generator>
+	size_t spawnObjects(size_t count, Generator&& generate) {
+		ParticleArrays particles;
+		particles.positions.reserve(count);
+		particles.velocities.reserve(count);
+		particles.radii.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			Scene::Body body = generate(i);
+			particles.push(body.position, body.velocity, body.radius);
+		}
+		return spawnObjects(particles);
+	}
+};
+
+
+// The modes that used to be picked with USE_QUEUE / USE_COLLISION_GRID / USE_THREADS.
+// They are instantiated once in Physics.cpp so every one of them is built into the library.
+using ContinuousPhysicsController = PhysicsController<UniformGridBroadPhase, ContinuousNarrowPhase, ThreadedScheduler>;
+using ContinuousSerialPhysicsController = PhysicsController<UniformGridBroadPhase, ContinuousNarrowPhase, SerialScheduler>;
+using DiscretePhysicsController = PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+using DiscreteSerialPhysicsController = PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, SerialScheduler>;
+using BruteForcePhysicsController = PhysicsController<BruteForceBroadPhase, DiscreteNarrowPhase, SerialScheduler>;
+using SpatialHashPhysicsController = PhysicsController<SpatialHashBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+using NeighbourListPhysicsController = PhysicsController<NeighbourListBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+using SpeculativePhysicsController = PhysicsController<NeighbourListBroadPhase, SpeculativeNarrowPhase, ThreadedScheduler>;
+using FixedPointPhysicsController = PhysicsController<UniformGridBroadPhase, FixedPointNarrowPhase<Q16_16>, SerialScheduler>;
+using DeterministicPhysicsController = PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, DeterministicScheduler>;
+
+using DefaultPhysicsController = ContinuousPhysicsController;
+
+extern template class PhysicsController<UniformGridBroadPhase, ContinuousNarrowPhase, ThreadedScheduler>;
+extern template class PhysicsController<UniformGridBroadPhase, ContinuousNarrowPhase, SerialScheduler>;
+extern template class PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+extern template class PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, SerialScheduler>;
+extern template class PhysicsController<BruteForceBroadPhase, DiscreteNarrowPhase, SerialScheduler>;
+extern template class PhysicsController<SpatialHashBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+extern template class PhysicsController<NeighbourListBroadPhase, DiscreteNarrowPhase, ThreadedScheduler>;
+extern template class PhysicsController<NeighbourListBroadPhase, SpeculativeNarrowPhase, ThreadedScheduler>;
+extern template class PhysicsController<UniformGridBroadPhase, FixedPointNarrowPhase<Q16_16>, SerialScheduler>;
+extern template class PhysicsController<UniformGridBroadPhase, DiscreteNarrowPhase, DeterministicScheduler>;
+extern template size_t ContinuousNarrowPhase::predictEvents(ContinuousPhysicsController& controller, float dt);
+extern template size_t ContinuousNarrowPhase::predictEvents(ContinuousSerialPhysicsController& controller, float dt);
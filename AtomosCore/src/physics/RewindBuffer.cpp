@@ -0,0 +1,187 @@
+#include "RewindBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+constexpr size_t OBJECT_WORDS = sizeof(RewindState::Object) / sizeof(uint32_t);
+static_assert(sizeof(RewindState::Object) == OBJECT_WORDS * sizeof(uint32_t), "objects are encoded word by word");
+
+
+namespace {
+	// seven bits a byte, low bits first, the top bit set on every byte but the last
+	void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+		while (value >= 0x80) {
+			out.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<uint8_t>(value));
+	}
+
+	bool getVarint(const std::vector<uint8_t>& in, size_t& cursor, uint32_t& value) {
+		value = 0;
+		for (int shift = 0; shift < 35 && cursor < in.size(); shift += 7) {
+			uint8_t byte = in[cursor++];
+			value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) return true;
+		}
+		return false;
+	}
+
+	// the difference wraps, so any pair of words round trips; small ones of either sign stay short
+	void putDifference(std::vector<uint8_t>& out, uint32_t value, uint32_t base) {
+		int32_t difference = static_cast<int32_t>(value - base);
+		putVarint(out, (static_cast<uint32_t>(difference) << 1) ^ static_cast<uint32_t>(difference >> 31));
+	}
+
+	bool getDifference(const std::vector<uint8_t>& in, size_t& cursor, uint32_t base, uint32_t& value) {
+		uint32_t zigzag;
+		if (!getVarint(in, cursor, zigzag)) return false;
+		value = base + ((zigzag >> 1) ^ (0u - (zigzag & 1)));
+		return true;
+	}
+
+	size_t keyframeBytes(const RewindState& state) {
+		return state.objects.size() * sizeof(RewindState::Object) + state.slots.size() * sizeof(uint32_t) +
+			state.spawnerClocks.size() * (sizeof(float) + 1);
+	}
+}
+
+
+RewindBuffer::RewindBuffer(uint32_t frames_, uint32_t keyframeInterval_) :
+	frames(std::max(frames_, 1u)), keyframeInterval(std::max(keyframeInterval_, 1u)) {}
+
+void RewindBuffer::capture(const RewindState& state) {
+	truncate(state.frame);
+
+	if (groups.empty() || groups.back().deltas.size() + 1 >= keyframeInterval) {
+		groups.emplace_back();
+		groups.back().keyframe = state;
+		bytes += keyframeBytes(state);
+	}
+	else {
+		Group& group = groups.back();
+		group.deltas.emplace_back();
+		encode(state, group.keyframe, group.deltas.back());
+		bytes += group.deltas.back().bytes.size() + sizeof(Delta);
+	}
+	frameCount++;
+	evict();
+}
+
+void RewindBuffer::truncate(uint64_t frame) {
+	while (!groups.empty()) {
+		Group& group = groups.back();
+		while (!group.deltas.empty() && group.deltas.back().frame >= frame) {
+			bytes -= group.deltas.back().bytes.size() + sizeof(Delta);
+			group.deltas.pop_back();
+			frameCount--;
+		}
+		if (group.keyframe.frame < frame) return;
+		bytes -= keyframeBytes(group.keyframe);
+		groups.pop_back();
+		frameCount--;
+	}
+}
+
+void RewindBuffer::evict() {
+	while (groups.size() > 1 && frameCount - (groups.front().deltas.size() + 1) >= frames) {
+		Group& group = groups.front();
+		frameCount -= group.deltas.size() + 1;
+		bytes -= keyframeBytes(group.keyframe);
+		for (const Delta& delta : group.deltas) bytes -= delta.bytes.size() + sizeof(Delta);
+		groups.pop_front();
+	}
+}
+
+// objects first, eight words each, then the handle table, each word against the keyframe's word in the same place
+void RewindBuffer::encode(const RewindState& state, const RewindState& keyframe, Delta& delta) {
+	delta.frame = state.frame;
+	delta.objectCount = static_cast<uint32_t>(state.objects.size());
+	delta.slotCount = static_cast<uint32_t>(state.slots.size());
+	delta.freeHandleSlot = state.freeHandleSlot;
+	delta.nextID = state.nextID;
+	delta.objectCounter = state.objectCount;
+	delta.spawnerClocks = state.spawnerClocks;
+	delta.spawnersShooting = state.spawnersShooting;
+
+	scratch.clear();
+	uint32_t words[OBJECT_WORDS];
+	uint32_t base[OBJECT_WORDS];
+	for (size_t i = 0; i < state.objects.size(); i++) {
+		std::memcpy(words, &state.objects[i], sizeof(words));
+		if (i < keyframe.objects.size()) std::memcpy(base, &keyframe.objects[i], sizeof(base));
+		else std::memset(base, 0, sizeof(base));
+		for (size_t w = 0; w < OBJECT_WORDS; w++) putDifference(scratch, words[w], base[w]);
+	}
+	for (size_t i = 0; i < state.slots.size(); i++) {
+		putDifference(scratch, state.slots[i], i < keyframe.slots.size() ? keyframe.slots[i] : 0);
+	}
+	delta.bytes.assign(scratch.begin(), scratch.end());
+}
+
+bool RewindBuffer::decode(const Delta& delta, const RewindState& keyframe, RewindState& out) const {
+	out.frame = delta.frame;
+	out.objects.resize(delta.objectCount);
+	out.slots.resize(delta.slotCount);
+	out.freeHandleSlot = delta.freeHandleSlot;
+	out.nextID = delta.nextID;
+	out.objectCount = delta.objectCounter;
+	out.spawnerClocks = delta.spawnerClocks;
+	out.spawnersShooting = delta.spawnersShooting;
+
+	size_t cursor = 0;
+	uint32_t words[OBJECT_WORDS];
+	uint32_t base[OBJECT_WORDS];
+	for (size_t i = 0; i < out.objects.size(); i++) {
+		if (i < keyframe.objects.size()) std::memcpy(base, &keyframe.objects[i], sizeof(base));
+		else std::memset(base, 0, sizeof(base));
+		for (size_t w = 0; w < OBJECT_WORDS; w++) {
+			if (!getDifference(delta.bytes, cursor, base[w], words[w])) return false;
+		}
+		std::memcpy(&out.objects[i], words, sizeof(words));
+	}
+	for (size_t i = 0; i < out.slots.size(); i++) {
+		if (!getDifference(delta.bytes, cursor, i < keyframe.slots.size() ? keyframe.slots[i] : 0, out.slots[i])) return false;
+	}
+	return cursor == delta.bytes.size();
+}
+
+bool RewindBuffer::restore(uint64_t frame, RewindState& out) const {
+	for (auto group = groups.rbegin(); group != groups.rend(); group++) {
+		if (group->keyframe.frame > frame) continue;
+		if (group->keyframe.frame == frame) {
+			out = group->keyframe;
+			return true;
+		}
+		// frames are captured one after another, so the delta sits at its distance from the keyframe
+		size_t index = static_cast<size_t>(frame - group->keyframe.frame - 1);
+		if (index >= group->deltas.size() || group->deltas[index].frame != frame) return false;
+		return decode(group->deltas[index], group->keyframe, out);
+	}
+	return false;
+}
+
+void RewindBuffer::clear() {
+	groups.clear();
+	frameCount = 0;
+	bytes = 0;
+}
+
+uint64_t RewindBuffer::getOldestFrame() const {
+	return groups.empty() ? 0 : groups.front().keyframe.frame;
+}
+
+uint64_t RewindBuffer::getNewestFrame() const {
+	if (groups.empty()) return 0;
+	const Group& group = groups.back();
+	return group.deltas.empty() ? group.keyframe.frame : group.deltas.back().frame;
+}
+
+size_t RewindBuffer::getFrameCount() const {
+	return frameCount;
+}
+
+size_t RewindBuffer::getBytes() const {
+	return bytes;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <glm.hpp>
+#include <stdint.h>
+
+
+// Everything a PhysicsWorld needs to carry on from the end of a frame. Objects are in the order the world
+// holds them; slots is its handle table as denseIndex, generation pairs.
+struct RewindState {
+	struct Object {
+		uint32_t id;
+		uint32_t slot;
+		uint32_t color;
+		float radius;
+		glm::vec2 position;
+		glm::vec2 velocity;
+	};
+
+	uint64_t frame = 0;
+	std::vector<Object> objects;
+	std::vector<uint32_t> slots;
+	uint32_t freeHandleSlot = UINT32_MAX;
+	uint32_t nextID = 0;
+	uint32_t objectCount = 0;				// the colour counter
+	std::vector<float> spawnerClocks;
+	std::vector<uint8_t> spawnersShooting;
+};
+
+
+// The last frames of a simulation, held in memory so it can be put back to any of them.
+//
+// Every keyframeInterval-th capture is kept whole as a keyframe; the ones between only keep how each
+// 32 bit word of their objects and handle table differs from the keyframe's, as zigzag varints. Words
+// past the end of the keyframe are taken against zero, so spawns and destroys only cost the objects they
+// move. Nothing is rounded, a restored frame is bit for bit the one captured. Restoring decodes a single
+// delta, whichever frame is asked for.
+//
+// At least frames frames are kept. The oldest keyframe goes together with its deltas, once the frames
+// after them still cover that many.
+class RewindBuffer {
+public:
+	RewindBuffer(uint32_t frames, uint32_t keyframeInterval);
+
+	// drops every frame from state.frame on first, so capturing after a restore starts a new history there
+	void capture(const RewindState& state);
+	// false if frame is not held
+	bool restore(uint64_t frame, RewindState& out) const;
+	void clear();
+
+	// 0 while empty
+	uint64_t getOldestFrame() const;
+	uint64_t getNewestFrame() const;
+	size_t getFrameCount() const;
+	// what the frames take, keyframes counted as their raw arrays
+	size_t getBytes() const;
+
+private:
+	struct Delta {
+		uint64_t frame;
+		uint32_t objectCount;
+		uint32_t slotCount;
+		uint32_t freeHandleSlot;
+		uint32_t nextID;
+		uint32_t objectCounter;
+		std::vector<float> spawnerClocks;
+		std::vector<uint8_t> spawnersShooting;
+		std::vector<uint8_t> bytes;
+	};
+
+	struct Group {
+		RewindState keyframe;
+		std::deque<Delta> deltas;
+	};
+
+	void truncate(uint64_t frame);
+	void evict();
+	void encode(const RewindState& state, const RewindState& keyframe, Delta& delta);
+	bool decode(const Delta& delta, const RewindState& keyframe, RewindState& out) const;
+
+	uint32_t frames;
+	uint32_t keyframeInterval;
+	std::deque<Group> groups;
+	size_t frameCount = 0;
+	size_t bytes = 0;
+	std::vector<uint8_t> scratch;		// deltas are encoded here and copied out at their exact size
+};
@@ -0,0 +1,215 @@
+#include "Scene.hpp"
+#include "Physics.hpp"
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+
+constexpr float PACKING_GAP = 1.05f;			// neighbours sit this many diameters apart, so nothing starts touching
+constexpr float HEX_ROW_HEIGHT = .8660254f;		// sqrt(3) / 2
+constexpr float GAS_SPEED = SPAWNER_EXIT_SPEED * 3.f;
+constexpr float DRIFT_SPEED = SPAWNER_EXIT_SPEED / 4.f;
+constexpr float DAM_WIDTH_FRACTION = 1.f / 3.f;
+constexpr int RADIUS_STEPS = 4;
+constexpr int HOTSPOTS = 4;
+constexpr float HOTSPOT_RADIUS = OBJECT_SIZE / 4.f;
+constexpr float HOTSPOT_SHARE = .75f;
+constexpr float RAIN_SPACING = OBJECT_SIZE * 8.f;
+constexpr float RAIN_SPEED = SPAWNER_EXIT_SPEED / 2.f;
+constexpr glm::vec2 FOUNTAIN_POSITION = { 75, 75 };
+constexpr uint32_t FOUNTAIN_SPAWNERS = 5;
+
+
+// std::mt19937 is specified bit for bit by the standard but its distributions are not,
+// so every value is derived from the raw engine output here
+class SceneRandom {
+	std::mt19937 engine;
+
+public:
+	SceneRandom(uint32_t seed) : engine(seed) {}
+
+	float uniform(float low, float high) {
+		return low + (high - low) * static_cast<float>(engine() >> 8) * (1.f / 16777216.f);
+	}
+	uint32_t below(uint32_t n) {
+		return static_cast<uint32_t>((static_cast<uint64_t>(engine()) * n) >> 32);
+	}
+	// rejection sampled from the unit disc, which needs no trig
+	glm::vec2 direction() {
+		while (true) {
+			glm::vec2 v = { uniform(-1.f, 1.f), uniform(-1.f, 1.f) };
+			float lengthSquared = glm::dot(v, v);
+			if (lengthSquared > .01f && lengthSquared <= 1.f) return v / std::sqrt(lengthSquared);
+		}
+	}
+};
+
+
+// hexagonal rows from the floor up between left and right, until count more bodies are placed or the
+// ceiling is reached, with every body nudged a little so the rows are not perfectly regular
+static void packRows(Scene& scene, float left, float right, uint32_t height, float radius, size_t count, SceneRandom& random) {
+	float spacing = radius * 2 * PACKING_GAP;
+	float jitter = (spacing - radius * 2) * .3f;		// two nudges along a diagonal still add up to less than the gap
+	size_t target = scene.bodies.size() + count;
+
+	for (int row = 0; scene.bodies.size() < target; row++) {
+		float y = height - spacing / 2 - row * spacing * HEX_ROW_HEIGHT;
+		if (y < spacing / 2) break;
+
+		for (float x = left + spacing / 2 + (row % 2) * spacing / 2; x <= right - spacing / 2 && scene.bodies.size() < target; x += spacing) {
+			glm::vec2 nudge = { random.uniform(-jitter, jitter), random.uniform(-jitter, jitter) };
+			scene.bodies.push_back({ glm::vec2(x, y) + nudge, glm::vec2(0), radius });
+		}
+	}
+}
+
+// Splits the world into at least count cells no narrower than a body of maxRadius needs and hands count
+// of them, spread evenly, to place, which puts one body inside the cell or returns false to leave it empty.
+template <typename Place>
+static void scatterLattice(Scene& scene, uint32_t width, uint32_t height, float maxRadius, size_t count, Place place) {
+	if (count == 0) return;
+	float minimumCell = maxRadius * 2 * PACKING_GAP;
+	float spacing = std::sqrt(static_cast<float>(width) * height / count);
+
+	uint32_t columns = std::max(1u, std::min(static_cast<uint32_t>(std::ceil(width / spacing)), static_cast<uint32_t>(width / minimumCell)));
+	uint32_t rows = std::max(1u, std::min(static_cast<uint32_t>(std::ceil(height / spacing)), static_cast<uint32_t>(height / minimumCell)));
+	size_t cells = static_cast<size_t>(columns) * rows;
+	count = std::min(count, cells);
+
+	glm::vec2 cellSize = { static_cast<float>(width) / columns, static_cast<float>(height) / rows };
+	for (size_t i = 0; i < count; i++) {
+		size_t cell = i * cells / count;
+		glm::vec2 low = glm::vec2(cell % columns, cell / columns) * cellSize;
+		Scene::Body body;
+		if (place(low, low + cellSize, body)) scene.bodies.push_back(body);
+	}
+}
+
+// somewhere inside the cell that keeps a body of radius clear of its neighbours
+static glm::vec2 placeInCell(glm::vec2 low, glm::vec2 high, float radius, SceneRandom& random) {
+	float margin = radius * PACKING_GAP;
+	return { random.uniform(low.x + margin, std::max(low.x + margin, high.x - margin)), random.uniform(low.y + margin, std::max(low.y + margin, high.y - margin)) };
+}
+
+
+Scene SceneLibrary::fountain(uint32_t width, uint32_t height, size_t objects) {
+	Scene scene;
+	scene.name = "fountain";
+	scene.spawners.push_back({ FOUNTAIN_POSITION, { 1, 0 }, SPAWNER_EXIT_SPEED, FOUNTAIN_SPAWNERS });
+	scene.spawnLimit = objects;
+	return scene;
+}
+
+Scene SceneLibrary::restingPile(uint32_t width, uint32_t height, size_t objects, uint32_t seed) {
+	SceneRandom random(seed);
+	Scene scene;
+	scene.name = "pile";
+	packRows(scene, 0.f, static_cast<float>(width), height, OBJECT_SIZE, objects, random);
+	scene.spawnLimit = scene.bodies.size();
+	return scene;
+}
+
+Scene SceneLibrary::gas(uint32_t width, uint32_t height, size_t objects, uint32_t seed) {
+	SceneRandom random(seed);
+	Scene scene;
+	scene.name = "gas";
+	scatterLattice(scene, width, height, OBJECT_SIZE, objects, [&](glm::vec2 low, glm::vec2 high, Scene::Body& body) {
+		body = { placeInCell(low, high, OBJECT_SIZE, random), random.direction() * GAS_SPEED, OBJECT_SIZE };
+		return true;
+	});
+	scene.spawnLimit = scene.bodies.size();
+	return scene;
+}
+
+Scene SceneLibrary::damBreak(uint32_t width, uint32_t height, size_t objects, uint32_t seed) {
+	SceneRandom random(seed);
+	Scene scene;
+	scene.name = "dam";
+	packRows(scene, 0.f, width * DAM_WIDTH_FRACTION, height, OBJECT_SIZE, objects, random);
+	scene.spawnLimit = scene.bodies.size();
+	return scene;
+}
+
+Scene SceneLibrary::mixedRadii(uint32_t width, uint32_t height, size_t objects, uint32_t seed) {
+	SceneRandom random(seed);
+	Scene scene;
+	scene.name = "mixed";
+	scatterLattice(scene, width, height, OBJECT_SIZE, objects, [&](glm::vec2 low, glm::vec2 high, Scene::Body& body) {
+		float radius = OBJECT_SIZE * static_cast<float>(1 + random.below(RADIUS_STEPS)) / RADIUS_STEPS;
+		body = { placeInCell(low, high, radius, random), random.direction() * DRIFT_SPEED, radius };
+		return true;
+	});
+	scene.spawnLimit = scene.bodies.size();
+	return scene;
+}
+
+Scene SceneLibrary::hotspot(uint32_t width, uint32_t height, size_t objects, uint32_t seed) {
+	SceneRandom random(seed);
+	Scene scene;
+	scene.name = "hotspot";
+
+	// discs side by side across the middle, each big enough for its share unless the world runs out of room
+	float spacing = HOTSPOT_RADIUS * 2 * PACKING_GAP;
+	size_t share = static_cast<size_t>(objects * HOTSPOT_SHARE) / HOTSPOTS;
+	float discRadius = std::sqrt(share * spacing * spacing * HEX_ROW_HEIGHT / PI) + spacing * 2;
+	discRadius = std::min({ discRadius, width / (HOTSPOTS * 2.f) - OBJECT_SIZE * 2, height / 2.f - OBJECT_SIZE * 2 });
+
+	std::vector<glm::vec2> centres;
+	for (int i = 0; i < HOTSPOTS; i++) {
+		float slack = height / 2.f - discRadius - OBJECT_SIZE * 2;
+		centres.push_back({ width * (i + .5f) / HOTSPOTS, height / 2.f + random.uniform(-slack, slack) });
+	}
+
+	for (glm::vec2 centre : centres) {
+		size_t target = scene.bodies.size() + share;
+		for (int row = 0; scene.bodies.size() < target; row++) {
+			float y = centre.y - discRadius + row * spacing * HEX_ROW_HEIGHT;
+			if (y > centre.y + discRadius) break;
+			for (float x = centre.x - discRadius + (row % 2) * spacing / 2; x <= centre.x + discRadius && scene.bodies.size() < target; x += spacing) {
+				if (glm::length(glm::vec2(x, y) - centre) <= discRadius - HOTSPOT_RADIUS) scene.bodies.push_back({ { x, y }, glm::vec2(0), HOTSPOT_RADIUS });
+			}
+		}
+	}
+
+	// the rest drift around the discs without starting inside one
+	scatterLattice(scene, width, height, OBJECT_SIZE, objects - scene.bodies.size(), [&](glm::vec2 low, glm::vec2 high, Scene::Body& body) {
+		for (glm::vec2 centre : centres) {
+			glm::vec2 nearest = glm::clamp(centre, low, high);
+			if (glm::length(nearest - centre) < discRadius + OBJECT_SIZE) return false;
+		}
+		body = { placeInCell(low, high, OBJECT_SIZE, random), random.direction() * DRIFT_SPEED, OBJECT_SIZE };
+		return true;
+	});
+	scene.spawnLimit = scene.bodies.size();
+	return scene;
+}
+
+Scene SceneLibrary::rain(uint32_t width, uint32_t height, size_t objects, uint32_t seed) {
+	SceneRandom random(seed);
+	Scene scene;
+	scene.name = "rain";
+	for (float x = RAIN_SPACING / 2; x < width - OBJECT_SIZE; x += RAIN_SPACING) {
+		float nudge = random.uniform(-RAIN_SPACING / 4, RAIN_SPACING / 4);
+		scene.spawners.push_back({ { x + nudge, OBJECT_SIZE * 2.f }, { 0, 1 }, RAIN_SPEED, 1 });
+	}
+	scene.spawnLimit = objects;
+	return scene;
+}
+
+
+const std::vector<std::string>& SceneLibrary::names() {
+	static const std::vector<std::string> sceneNames = { "fountain", "pile", "gas", "dam", "mixed", "hotspot", "rain" };
+	return sceneNames;
+}
+
+bool SceneLibrary::make(const std::string& name, uint32_t width, uint32_t height, size_t objects, Scene& scene, uint32_t seed) {
+	if (name == "fountain") scene = fountain(width, height, objects);
+	else if (name == "pile") scene = restingPile(width, height, objects, seed);
+	else if (name == "gas") scene = gas(width, height, objects, seed);
+	else if (name == "dam") scene = damBreak(width, height, objects, seed);
+	else if (name == "mixed") scene = mixedRadii(width, height, objects, seed);
+	else if (name == "hotspot") scene = hotspot(width, height, objects, seed);
+	else if (name == "rain") scene = rain(width, height, objects, seed);
+	else return false;
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <glm.hpp>
+#include <stdint.h>
+
+
+// A world to start from: bodies placed up front and spawners that keep adding more until the world
+// holds spawnLimit objects. PhysicsWorld::loadScene replaces everything in a world with one.
+struct Scene {
+	struct Body {
+		glm::vec2 position;
+		glm::vec2 velocity;
+		float radius;
+	};
+
+	// count spawners stacked from position by the usual spawner offset
+	struct Spawner {
+		glm::vec2 position;
+		glm::vec2 direction;
+		float speed;
+		uint32_t count;
+	};
+
+	std::string name;
+	std::vector<Body> bodies;
+	std::vector<Spawner> spawners;
+	size_t spawnLimit = 0;
+};
+
+
+// The standard scenes, each stressing a different regime. A scene is built only from its arguments with
+// a generator whose output the standard fixes, so the same arguments give the same bodies on every
+// machine and compiler and runs at the same scale can be compared. objects is the number of objects the
+// scene should reach; scenes that place their bodies up front stop early once the world is full.
+class SceneLibrary {
+public:
+	static constexpr uint32_t DEFAULT_SEED = 0xA70338;
+
+	// the five stacked spawners the engine has always started with
+	static Scene fountain(uint32_t width, uint32_t height, size_t objects);
+	// hexagonally packed rows resting on the floor, the "fill the screen" goal
+	static Scene restingPile(uint32_t width, uint32_t height, size_t objects, uint32_t seed = DEFAULT_SEED);
+	// sparse objects spread over the whole world, all moving fast in random directions
+	static Scene gas(uint32_t width, uint32_t height, size_t objects, uint32_t seed = DEFAULT_SEED);
+	// a packed column against the left wall that collapses across the floor
+	static Scene damBreak(uint32_t width, uint32_t height, size_t objects, uint32_t seed = DEFAULT_SEED);
+	// objects of every radius from a quarter of OBJECT_SIZE up to OBJECT_SIZE, falling from rest
+	static Scene mixedRadii(uint32_t width, uint32_t height, size_t objects, uint32_t seed = DEFAULT_SEED);
+	// most objects packed small into a few discs so a handful of cells hold far more than the rest
+	static Scene hotspot(uint32_t width, uint32_t height, size_t objects, uint32_t seed = DEFAULT_SEED);
+	// a row of spawners along the ceiling, all shooting down
+	static Scene rain(uint32_t width, uint32_t height, size_t objects, uint32_t seed = DEFAULT_SEED);
+
+	static const std::vector<std::string>& names();
+	// builds the scene called name, returns false for a name that is not in names()
+	static bool make(const std::string& name, uint32_t width, uint32_t height, size_t objects, Scene& scene, uint32_t seed = DEFAULT_SEED);
+};
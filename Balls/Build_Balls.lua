@@ -11,7 +11,8 @@ project "Balls"
 
 
     links {
-        "Atomos"
+        "Atomos",
+        "AtomosCore"
     }
 
     includedirs {
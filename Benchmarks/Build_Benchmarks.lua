@@ -0,0 +1,46 @@
+project "Benchmarks"
+    kind "ConsoleApp"
+    language "C++"
+    targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+
+    files { 
+	    "./src/**.hpp", 
+	    "./src/**.cpp",
+	    "Build_Benchmarks.lua" 
+    } 
+
+
+    links {
+        "Atomos",
+        "AtomosCore",
+        "ImGui"
+    }
+
+    includedirs {
+        "src",
+        "%{wks.location}/AtomosCore/src",
+        "%{wks.location}/Atomos/src",
+        "%{wks.location}/Atomos/lib/glm",
+        "%{wks.location}/Atomos/lib/ImGui"
+    }
+    
+    --Benchmarks are only meaningful with optimizations on, so Debug keeps symbols but still optimizes
+    filter "configurations:Debug"
+        defines { "DEBUG" }
+        symbols "On"
+        optimize "On"
+
+    filter "configurations:Release"
+        defines { "NDEBUG" }
+        optimize "On"
+
+    filter { }
+
+    --the worker pools use std::thread
+    filter "system:linux"
+        links { "pthread" }
+    filter { }
+
+    filter { "system:windows", "action:gmake2" }
+        buildoptions { "-M" }
+    filter { }
@@ -0,0 +1,18 @@
+#include "Benchmarks.hpp"
+
+#include <string>
+#include <iostream>
+
+
+int main(int argc, char** argv) {
+	std::string suite = argc > 1 ? argv[1] : "stress";
+	int suiteArgc = argc > 1 ? argc - 2 : 0;
+	char** suiteArgv = argv + (argc > 1 ? 2 : 1);
+
+	if (suite == "stress") return runStress(suiteArgc, suiteArgv);
+	if (suite == "micro") return runMicro(suiteArgc, suiteArgv);
+	if (suite == "scenes") return runScenes(suiteArgc, suiteArgv);
+
+	std::cerr << "Unknown benchmark suite: " << suite << "\n\tAvailable suites: stress, micro, scenes" << std::endl;
+	return 1;
+}
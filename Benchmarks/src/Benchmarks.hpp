@@ -0,0 +1,6 @@
+#pragma once
+
+// Each suite takes the arguments that follow its name on the command line and returns the process exit code
+int runStress(int argc, char** argv);
+int runMicro(int argc, char** argv);
+int runScenes(int argc, char** argv);
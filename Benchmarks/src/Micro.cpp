@@ -0,0 +1,461 @@
+#include "Benchmarks.hpp"
+#include "physics/Physics.hpp"
+#include "Timer.hpp"
+#include "SimulationView.hpp"
+#include "imgui.h"
+
+#include <random>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cfloat>
+#include <algorithm>
+
+// Microbenchmarks of single engine kernels. Every kernel runs on synthetic particles drawn from a
+// fixed seed, so two builds time exactly the same work and their JSON output can be diffed.
+
+constexpr uint32_t MICRO_SEED = 0xA70337;
+constexpr int DEFAULT_MICRO_REPETITIONS = 5;
+constexpr const char* DEFAULT_MICRO_OUTPUT = "atomos_micro.json";
+
+constexpr size_t MICRO_OBJECTS = 20000;
+constexpr size_t MICRO_PAIRS = 100000;
+constexpr size_t MICRO_TASKS = 20000;
+constexpr size_t MICRO_FRAMES = 20;
+
+constexpr uint32_t MICRO_WORLD_WIDTH = 2048;
+constexpr uint32_t MICRO_WORLD_HEIGHT = 2048;
+constexpr float MICRO_RADIUS = 4.f;
+constexpr float MICRO_SPEED = 160.f;
+constexpr const char* MICRO_SHARED_NAME = "/atomos_micro";
+constexpr uint32_t MICRO_SHARED_SLOTS = 4;
+constexpr const char* MICRO_TRAJECTORY_PATH = "atomos_micro.atrj";
+constexpr float MICRO_TRAJECTORY_QUANTUM = 1.f / 64.f;
+constexpr uint32_t MICRO_TRAJECTORY_KEYFRAMES = 60;
+constexpr uint32_t MICRO_REWIND_KEYFRAMES = 30;
+
+constexpr int MICRO_CLUSTERS = 16;
+constexpr float MICRO_CLUSTER_SPREAD = 40.f;
+
+
+struct MicroResult {
+	std::string name;
+	size_t operations;
+	size_t itemsPerOperation;
+	double nanosPerOperation;
+	double itemsPerSecond;
+};
+
+static std::vector<MicroResult> results;
+
+// runs kernel repetitions times and keeps the fastest, kernel returns the milliseconds its operations took
+// so that any setup it redoes between runs stays out of the measurement
+template <typename Kernel>
+static void measure(const std::string& name, size_t operations, size_t itemsPerOperation, int repetitions, Kernel kernel) {
+	double bestMillis = DBL_MAX;
+	for (int i = 0; i < repetitions; i++) bestMillis = std::min(bestMillis, static_cast<double>(kernel()));
+
+	double nanosPerOperation = bestMillis * 1e6 / operations;
+	double itemsPerSecond = operations * itemsPerOperation / (bestMillis / 1000.0);
+	results.push_back({ name, operations, itemsPerOperation, nanosPerOperation, itemsPerSecond });
+	printf("  %-44s %12.1f ns/op  %14.0f items/s\n", name.c_str(), nanosPerOperation, itemsPerSecond);
+}
+
+
+enum class Distribution { UNIFORM, CLUSTERED };
+
+static const char* distributionName(Distribution distribution) {
+	return distribution == Distribution::UNIFORM ? "uniform" : "clustered";
+}
+
+// positions inside the world, either spread evenly or bunched into gaussian blobs
+static std::vector<glm::vec2> scatter(size_t count, Distribution distribution, std::mt19937& rng) {
+	float margin = MICRO_RADIUS * 2;
+	std::uniform_real_distribution<float> x(margin, MICRO_WORLD_WIDTH - margin);
+	std::uniform_real_distribution<float> y(margin, MICRO_WORLD_HEIGHT - margin);
+
+	std::vector<glm::vec2> centres;
+	for (int i = 0; i < MICRO_CLUSTERS; i++) centres.push_back({ x(rng), y(rng) });
+	std::uniform_int_distribution<int> cluster(0, MICRO_CLUSTERS - 1);
+	std::normal_distribution<float> spread(0.f, MICRO_CLUSTER_SPREAD);
+
+	std::vector<glm::vec2> positions;
+	positions.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		glm::vec2 position = distribution == Distribution::UNIFORM ? glm::vec2(x(rng), y(rng)) : centres[cluster(rng)] + glm::vec2(spread(rng), spread(rng));
+		positions.push_back(glm::clamp(position, glm::vec2(margin), glm::vec2(MICRO_WORLD_WIDTH - margin, MICRO_WORLD_HEIGHT - margin)));
+	}
+	return positions;
+}
+
+static std::vector<PhysicsWorld::PhysicsObject*> makeObjects(const std::vector<glm::vec2>& positions, std::mt19937& rng) {
+	std::uniform_real_distribution<float> v(-MICRO_SPEED, MICRO_SPEED);
+	std::vector<PhysicsWorld::PhysicsObject*> objects;
+	objects.reserve(positions.size());
+	for (glm::vec2 position : positions) objects.push_back(new PhysicsWorld::PhysicsObject(nullptr, position, MICRO_RADIUS, { v(rng), v(rng) }));
+	return objects;
+}
+
+
+// gives the benchmarks the same access to the world that a spawner has
+template <typename Controller>
+class MicroController : public Controller {
+public:
+	using Controller::Controller;
+
+	void populate(const std::vector<glm::vec2>& positions, std::mt19937& rng) {
+		std::uniform_real_distribution<float> v(-MICRO_SPEED, MICRO_SPEED);
+		this->stopSpawners();
+		for (glm::vec2 position : positions) this->addObject(new PhysicsWorld::PhysicsObject(this, position, MICRO_RADIUS, { v(rng), v(rng) }));
+	}
+};
+
+
+// pair resolution, with every pair overlapping or every pair apart
+static void microCheckCollision(bool overlapping, int repetitions, std::mt19937& rng) {
+	std::uniform_real_distribution<float> x(MICRO_RADIUS * 4, MICRO_WORLD_WIDTH - MICRO_RADIUS * 4);
+	std::uniform_real_distribution<float> y(MICRO_RADIUS * 4, MICRO_WORLD_HEIGHT - MICRO_RADIUS * 4);
+	std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+	std::uniform_real_distribution<float> distance = overlapping ? std::uniform_real_distribution<float>(MICRO_RADIUS * .5f, MICRO_RADIUS * 1.9f)
+		: std::uniform_real_distribution<float>(MICRO_RADIUS * 2.1f, MICRO_RADIUS * 3.5f);
+
+	std::vector<glm::vec2> positions;
+	for (size_t i = 0; i < MICRO_PAIRS; i++) {
+		glm::vec2 position(x(rng), y(rng));
+		float a = angle(rng);
+		positions.push_back(position);
+		positions.push_back(position + distance(rng) * glm::vec2(cos(a), sin(a)));
+	}
+	std::vector<PhysicsWorld::PhysicsObject*> objects = makeObjects(positions, rng);
+
+	measure(std::string("checkCollision/") + (overlapping ? "overlapping" : "apart"), MICRO_PAIRS, 1, repetitions, [&]() {
+		// resolving a pair moves it apart, so every run starts from the original positions
+		for (size_t i = 0; i < objects.size(); i++) objects[i]->position = positions[i];
+
+		Timer timer;
+		timer.start();
+		for (size_t i = 0; i < objects.size(); i += 2) DiscreteNarrowPhase::checkCollision(objects[i], objects[i + 1], MICRO_WORLD_WIDTH, MICRO_WORLD_HEIGHT);
+		return timer.readSplitMillis();
+	});
+
+	for (auto obj : objects) delete obj;
+}
+
+// the first event prediction of every object, as the continuous narrow phase queues them
+static void microPredictEvents(Distribution distribution, int repetitions, std::mt19937& rng) {
+	MicroController<ContinuousSerialPhysicsController> controller(MICRO_WORLD_WIDTH, MICRO_WORLD_HEIGHT);
+	controller.populate(scatter(MICRO_OBJECTS, distribution, rng), rng);
+	controller.update(1.f / 60.f);
+
+	size_t queued = 0;
+	measure(std::string("addCollisionsToQueue/") + distributionName(distribution), MICRO_OBJECTS, 1, repetitions, [&]() {
+		Timer timer;
+		timer.start();
+		queued = controller.getNarrowPhase().predictEvents<ContinuousSerialPhysicsController>(controller, 1.f / 60.f);
+		return timer.readSplitMillis();
+	});
+	if (queued == 0) std::cerr << "  no events were predicted" << std::endl;
+}
+
+// filling and emptying the collision grid, and unlinking every object from its cell
+static void microGrid(Distribution distribution, int repetitions, std::mt19937& rng) {
+	std::vector<PhysicsWorld::PhysicsObject*> objects = makeObjects(scatter(MICRO_OBJECTS, distribution, rng), rng);
+	// borrowed from an empty controller so it has the cell size and extent the engine would give this world
+	DiscreteSerialPhysicsController controller(MICRO_WORLD_WIDTH, MICRO_WORLD_HEIGHT);
+	PhysicsWorld::CollisionGrid& grid = *controller.getBroadPhase().grid;
+	std::string suffix = std::string("/") + distributionName(distribution);
+
+	measure("GridContainer::insert" + suffix, MICRO_OBJECTS, 1, repetitions, [&]() {
+		grid.clear();
+		Timer timer;
+		timer.start();
+		for (auto obj : objects) grid.insert(obj);
+		return timer.readSplitMillis();
+	});
+
+	measure("GridContainer::clear" + suffix, 1, grid.getNumCells(), repetitions, [&]() {
+		for (auto obj : objects) grid.insert(obj);
+		Timer timer;
+		timer.start();
+		grid.clear();
+		return timer.readSplitMillis();
+	});
+
+	measure("CollisionNode::remove" + suffix, MICRO_OBJECTS, 1, repetitions, [&]() {
+		grid.clear();
+		for (auto obj : objects) grid.insert(obj);
+		Timer timer;
+		timer.start();
+		for (auto obj : objects) grid.getCell(obj->cell)->remove(obj);
+		return timer.readSplitMillis();
+	});
+
+	for (auto obj : objects) delete obj;
+}
+
+// a lone task there and back, then batches of tasks of growing size
+static void microThreadPool(int repetitions) {
+	ThreadPool pool(THREAD_COUNT);
+
+	measure("ThreadPool::addTask/round trip", MICRO_TASKS, 1, repetitions, [&]() {
+		Timer timer;
+		timer.start();
+		for (size_t i = 0; i < MICRO_TASKS; i++) pool.addTask([]() {}).wait();
+		return timer.readSplitMillis();
+	});
+
+	for (uint32_t work : { 0u, 100u, 1000u, 10000u }) {
+		std::vector<std::future<uint32_t>> tasks(MICRO_TASKS);
+		measure("ThreadPool::addTask/throughput work:" + std::to_string(work), MICRO_TASKS, 1, repetitions, [&]() {
+			Timer timer;
+			timer.start();
+			for (size_t i = 0; i < MICRO_TASKS; i++) {
+				tasks[i] = pool.addTask([work, i]() {
+					// an xorshift chain the compiler cannot fold away
+					uint32_t state = static_cast<uint32_t>(i) | 1;
+					for (uint32_t j = 0; j < work; j++) {
+						state ^= state << 13;
+						state ^= state >> 17;
+						state ^= state << 5;
+					}
+					return state;
+				});
+			}
+			for (auto& task : tasks) task.get();
+			return timer.readSplitMillis();
+		});
+	}
+}
+
+// building the draw list for one published snapshot, without a GL context
+static void microDisplay(Distribution distribution, int repetitions, std::mt19937& rng) {
+	MicroController<DiscreteSerialPhysicsController> controller(MICRO_WORLD_WIDTH, MICRO_WORLD_HEIGHT);
+	controller.populate(scatter(MICRO_OBJECTS, distribution, rng), rng);
+	controller.update(1.f / 60.f);
+
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;	// as the OpenGL3 backend sets it, a frame holds more than 64k vertices
+	io.DisplaySize = { static_cast<float>(MICRO_WORLD_WIDTH) * 2, static_cast<float>(MICRO_WORLD_HEIGHT) * 2 };
+	unsigned char* pixels;
+	int width, height;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+	SimulationView view(&controller);
+
+	// whole world at its own scale, then zoomed in on a corner, then zoomed out far enough for heatmap blocks
+	const std::pair<const char*, float> zooms[] = { { "", 1.f }, { "/zoomed in", 4.f }, { "/zoomed out", .25f } };
+	for (auto [suffix, zoom] : zooms) {
+		view.setView(0.f, 0.f, zoom);
+		measure(std::string("displaySimulation/") + distributionName(distribution) + suffix, MICRO_FRAMES, MICRO_OBJECTS, repetitions, [&]() {
+			Timer timer;
+			timer.start();
+			for (size_t i = 0; i < MICRO_FRAMES; i++) {
+				io.DeltaTime = 1.f / 60.f;
+				ImGui::NewFrame();
+				view.displaySimulation();
+				ImGui::Render();
+			}
+			return timer.readSplitMillis();
+		});
+		printf("  %-44s %12d vertices per frame\n", "", ImGui::GetDrawData()->TotalVtxCount);
+	}
+
+	ImGui::DestroyContext();
+}
+
+// filling ring slots from particle arrays, and copying the latest frame back out through a second mapping
+static void microSharedFrames(int repetitions, std::mt19937& rng) {
+	MicroController<DiscreteSerialPhysicsController> controller(MICRO_WORLD_WIDTH, MICRO_WORLD_HEIGHT);
+	controller.populate(scatter(MICRO_OBJECTS, Distribution::UNIFORM, rng), rng);
+	PhysicsWorld::ParticleArrays particles;
+	controller.readParticles(particles);
+
+	SharedFrameRing* writer = SharedFrameRing::create(MICRO_SHARED_NAME, MICRO_SHARED_SLOTS, MICRO_OBJECTS);
+	SharedFrameRing* reader = writer ? SharedFrameRing::open(MICRO_SHARED_NAME) : 0;
+	if (!reader) {
+		printf("  %-44s no shared memory on this system\n", "SharedFrameRing");
+		delete writer;
+		return;
+	}
+
+	uint64_t frame = 0;
+	uint32_t count = static_cast<uint32_t>(particles.size());
+	measure("SharedFrameRing::write", MICRO_FRAMES, MICRO_OBJECTS, repetitions, [&]() {
+		Timer timer;
+		timer.start();
+		for (size_t f = 0; f < MICRO_FRAMES; f++) {
+			SharedFrameRing::Arrays arrays = writer->beginWrite(++frame);
+			for (uint32_t i = 0; i < count; i++) {
+				arrays.positions[2 * i] = particles.positions[i].x;
+				arrays.positions[2 * i + 1] = particles.positions[i].y;
+				arrays.velocities[2 * i] = particles.velocities[i].x;
+				arrays.velocities[2 * i + 1] = particles.velocities[i].y;
+				arrays.radii[i] = particles.radii[i];
+				arrays.colors[i] = i;
+				arrays.ids[i] = i;
+			}
+			writer->endWrite(count, count);
+		}
+		return timer.readSplitMillis();
+	});
+
+	SharedFrameRing::Frame copy;
+	measure("SharedFrameRing::readLatest", MICRO_FRAMES, MICRO_OBJECTS, repetitions, [&]() {
+		Timer timer;
+		timer.start();
+		for (size_t f = 0; f < MICRO_FRAMES; f++) {
+			copy.frame = 0;
+			reader->readLatest(copy);
+		}
+		return timer.readSplitMillis();
+	});
+
+	delete reader;
+	delete writer;
+}
+
+// handing frames to the recorder thread as the simulation does, encoding and writing included since the
+// recorder holds the simulation up once it falls behind; the objects drift a little every frame
+static void microTrajectory(int repetitions, std::mt19937& rng) {
+	std::vector<glm::vec2> positions = scatter(MICRO_OBJECTS, Distribution::UNIFORM, rng);
+	std::uniform_real_distribution<float> drift(-.5f, .5f);
+	std::vector<glm::vec2> steps(MICRO_OBJECTS);
+	for (glm::vec2& step : steps) step = glm::vec2(drift(rng), drift(rng));
+
+	// every repetition opens its own recording, so the first tells whether the path is writable at all
+	TrajectoryRecorder* probe = TrajectoryRecorder::create(MICRO_TRAJECTORY_PATH, MICRO_TRAJECTORY_QUANTUM, MICRO_TRAJECTORY_KEYFRAMES);
+	if (!probe) {
+		printf("  %-44s could not write %s\n", "TrajectoryRecorder", MICRO_TRAJECTORY_PATH);
+		return;
+	}
+	delete probe;
+
+	measure("TrajectoryRecorder::frame", MICRO_FRAMES, MICRO_OBJECTS, repetitions, [&]() {
+		TrajectoryRecorder* recorder = TrajectoryRecorder::create(MICRO_TRAJECTORY_PATH, MICRO_TRAJECTORY_QUANTUM, MICRO_TRAJECTORY_KEYFRAMES);
+		if (!recorder) return FLT_MAX;		// lost the path since the probe, the best of the other repetitions stands
+		Timer timer;
+		timer.start();
+		for (size_t f = 0; f < MICRO_FRAMES; f++) {
+			TrajectoryFrame& frame = recorder->beginFrame();
+			frame.frame = f + 1;
+			frame.ids.resize(MICRO_OBJECTS);
+			frame.positions.resize(MICRO_OBJECTS);
+			for (size_t i = 0; i < MICRO_OBJECTS; i++) {
+				frame.ids[i] = static_cast<uint32_t>(i);
+				frame.positions[i] = positions[i] + steps[i] * static_cast<float>(f);
+			}
+			recorder->endFrame();
+		}
+		delete recorder;
+		return timer.readSplitMillis();
+	});
+	std::ifstream file(MICRO_TRAJECTORY_PATH, std::ios::binary | std::ios::ate);
+	double bytesPerObject = file ? static_cast<double>(file.tellg()) / (MICRO_FRAMES * MICRO_OBJECTS) : 0.0;
+	printf("  %-44s %12.2f bytes per object and frame\n", "", bytesPerObject);
+	file.close();
+	std::remove(MICRO_TRAJECTORY_PATH);
+}
+
+
+// the same drifting particles as microTrajectory, kept in memory losslessly rather than written out
+static void microRewind(int repetitions, std::mt19937& rng) {
+	std::vector<glm::vec2> positions = scatter(MICRO_OBJECTS, Distribution::UNIFORM, rng);
+	std::uniform_real_distribution<float> drift(-.5f, .5f);
+	RewindState state;
+	state.objects.resize(MICRO_OBJECTS);
+	state.slots.resize(2 * MICRO_OBJECTS);
+	for (size_t i = 0; i < MICRO_OBJECTS; i++) {
+		glm::vec2 step(drift(rng), drift(rng));
+		state.objects[i] = { static_cast<uint32_t>(i), static_cast<uint32_t>(i), 0, MICRO_RADIUS, positions[i], step };
+		state.slots[2 * i] = static_cast<uint32_t>(i);
+	}
+	auto frameState = [&](size_t f) {
+		state.frame = f + 1;
+		for (size_t i = 0; i < MICRO_OBJECTS; i++) state.objects[i].position = positions[i] + state.objects[i].velocity * static_cast<float>(f);
+	};
+
+	RewindBuffer buffer(MICRO_FRAMES, MICRO_REWIND_KEYFRAMES);
+	measure("RewindBuffer::capture", MICRO_FRAMES, MICRO_OBJECTS, repetitions, [&]() {
+		buffer.clear();
+		Timer timer;
+		timer.start();
+		for (size_t f = 0; f < MICRO_FRAMES; f++) {
+			frameState(f);
+			buffer.capture(state);
+		}
+		return timer.readSplitMillis();
+	});
+	printf("  %-44s %12.2f bytes per object and frame\n", "", static_cast<double>(buffer.getBytes()) / (MICRO_FRAMES * MICRO_OBJECTS));
+
+	RewindState restored;
+	measure("RewindBuffer::restore", MICRO_FRAMES, MICRO_OBJECTS, repetitions, [&]() {
+		Timer timer;
+		timer.start();
+		for (size_t f = 0; f < MICRO_FRAMES; f++) buffer.restore(f + 1, restored);
+		return timer.readSplitMillis();
+	});
+}
+
+
+static bool writeJson(const std::string& path, int repetitions) {
+	std::ofstream file(path);
+	if (!file) return false;
+
+	file << "{\n  \"suite\": \"micro\",\n  \"seed\": " << MICRO_SEED << ",\n  \"repetitions\": " << repetitions << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const MicroResult& result = results[i];
+		char line[512];
+		snprintf(line, sizeof(line), "    { \"name\": \"%s\", \"operations\": %zu, \"items_per_operation\": %zu, \"ns_per_op\": %.3f, \"items_per_second\": %.1f }%s\n",
+			result.name.c_str(), result.operations, result.itemsPerOperation, result.nanosPerOperation, result.itemsPerSecond, i + 1 < results.size() ? "," : "");
+		file << line;
+	}
+	file << "  ]\n}\n";
+	return true;
+}
+
+
+int runMicro(int argc, char** argv) {
+	std::string output = argc > 0 ? argv[0] : DEFAULT_MICRO_OUTPUT;
+	int repetitions = argc > 1 ? std::max(1, std::stoi(argv[1])) : DEFAULT_MICRO_REPETITIONS;
+
+	std::cout << "micro: best of " << repetitions << " runs, seed " << MICRO_SEED << std::endl;
+	for (bool overlapping : { true, false }) {
+		std::mt19937 rng(MICRO_SEED);
+		microCheckCollision(overlapping, repetitions, rng);
+	}
+	for (Distribution distribution : { Distribution::UNIFORM, Distribution::CLUSTERED }) {
+		std::mt19937 rng(MICRO_SEED);
+		microPredictEvents(distribution, repetitions, rng);
+	}
+	for (Distribution distribution : { Distribution::UNIFORM, Distribution::CLUSTERED }) {
+		std::mt19937 rng(MICRO_SEED);
+		microGrid(distribution, repetitions, rng);
+	}
+	microThreadPool(repetitions);
+	for (Distribution distribution : { Distribution::UNIFORM, Distribution::CLUSTERED }) {
+		std::mt19937 rng(MICRO_SEED);
+		microDisplay(distribution, repetitions, rng);
+	}
+	{
+		std::mt19937 rng(MICRO_SEED);
+		microSharedFrames(repetitions, rng);
+	}
+	{
+		std::mt19937 rng(MICRO_SEED);
+		microTrajectory(repetitions, rng);
+	}
+	{
+		std::mt19937 rng(MICRO_SEED);
+		microRewind(repetitions, rng);
+	}
+
+	if (!writeJson(output, repetitions)) {
+		std::cerr << "micro: could not write " << output << std::endl;
+		return 1;
+	}
+	std::cout << "micro: wrote " << results.size() << " results to " << output << std::endl;
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include "Benchmarks.hpp"
+#include "physics/Physics.hpp"
+#include "Timer.hpp"
+
+#include <string>
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+// Runs every standard scene on every controller. Worlds grow with the object count so each scene keeps
+// the same density at any scale, and scenes come out of SceneLibrary identical on every machine.
+
+constexpr size_t DEFAULT_SCENE_OBJECTS = 4000;
+constexpr int DEFAULT_SCENE_FRAMES = 120;
+constexpr float SCENE_AREA_PER_OBJECT = 256.f;		// square pixels of world per object
+constexpr uint32_t SCENE_MINIMUM_SIDE = 256;
+
+
+static uint32_t sceneSide(size_t objects) {
+	return std::max(SCENE_MINIMUM_SIDE, static_cast<uint32_t>(std::sqrt(objects * SCENE_AREA_PER_OBJECT)));
+}
+
+// frames are always 60 Hz frames; a controller stepped at a lower rate covers the same simulated time in fewer steps
+template <typename Controller>
+static bool runScene(const char* controllerName, const Scene& scene, uint32_t side, int frames, CpuTopology::Placement placement, int rate = 60) {
+	Controller controller(side, side);
+	controller.loadScene(scene);
+	controller.setThreadPlacement(placement);
+
+	Timer timer;
+	timer.start();
+	for (int i = 0; i < frames * rate / 60; i++) controller.update(1.f / rate);
+	float millis = timer.readSplitMillis();
+
+	const PhysicsWorld::FrameMetrics& metrics = controller.getFrameMetrics();
+	printf("  %-10s %-22s %10.3f ms/frame  %8zu objects  %10llu pair tests  %8llu contacts  %6u max per cell  %3u substeps\n", scene.name.c_str(), controllerName,
+		millis / frames, controller.getNumObjects(), static_cast<unsigned long long>(metrics.pairTests), static_cast<unsigned long long>(metrics.contacts), metrics.maxObjectsPerCell, metrics.substeps);
+	return controller.getNumObjects() > 0;
+}
+
+
+int runScenes(int argc, char** argv) {
+	size_t objects = argc > 0 ? std::stoull(argv[0]) : DEFAULT_SCENE_OBJECTS;
+	int frames = argc > 1 ? std::stoi(argv[1]) : DEFAULT_SCENE_FRAMES;
+	CpuTopology::Placement placement = DEFAULT_THREAD_PLACEMENT;
+	if (argc > 2 && !CpuTopology::parsePlacement(argv[2], placement)) {
+		std::cerr << "scenes: unknown placement " << argv[2] << ", expected unpinned, compact, scatter or physical_cores" << std::endl;
+		return 1;
+	}
+	uint32_t side = sceneSide(objects);
+
+	const CpuTopology& topology = CpuTopology::get();
+	std::cout << "scenes: " << side << "x" << side << " world, up to " << objects << " objects, " << frames << " frames, workers "
+		<< CpuTopology::placementName(placement) << " on " << topology.cpus.size() << " cpus, " << topology.numCores() << " cores, " << topology.numNodes() << " nodes" << std::endl;
+	int failures = 0;
+	for (const std::string& name : SceneLibrary::names()) {
+		Scene scene;
+		SceneLibrary::make(name, side, side, objects, scene);
+
+		failures += !runScene<DiscreteSerialPhysicsController>("discrete serial", scene, side, frames, placement);
+		failures += !runScene<DiscretePhysicsController>("discrete threaded", scene, side, frames, placement);
+		failures += !runScene<DeterministicPhysicsController>("discrete deterministic", scene, side, frames, placement);
+		failures += !runScene<FixedPointPhysicsController>("fixed point", scene, side, frames, placement);
+		failures += !runScene<SpatialHashPhysicsController>("spatial hash", scene, side, frames, placement);
+		failures += !runScene<NeighbourListPhysicsController>("neighbour list", scene, side, frames, placement);
+		failures += !runScene<SpeculativePhysicsController>("speculative 30 Hz", scene, side, frames, placement, 30);
+		failures += !runScene<ContinuousSerialPhysicsController>("continuous serial", scene, side, frames, placement);
+		failures += !runScene<ContinuousPhysicsController>("continuous threaded", scene, side, frames, placement);
+	}
+
+	if (failures) std::cout << "scenes: " << failures << " runs ended with an empty world" << std::endl;
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,509 @@
+#include "Benchmarks.hpp"
+#include "physics/Physics.hpp"
+#include "Timer.hpp"
+
+#include <random>
+#include <string>
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
+
+// Large-world stress run. Populates worlds well past the old 8/16-bit limits and checks that
+// every count still adds up afterwards, timing each stage along the way.
+
+constexpr size_t DEFAULT_STRESS_OBJECTS = 1000000;
+constexpr int DEFAULT_STRESS_FRAMES = 3;
+constexpr uint32_t STRESS_SEED = 0xA70305;
+
+constexpr uint32_t STRESS_GRID_WIDTH = 100000;	// cells, well past what a uint16_t can index
+constexpr uint32_t STRESS_GRID_HEIGHT = 4;
+constexpr uint32_t STRESS_PILE = 300;			// objects dropped in a single cell, more than a uint8_t can count
+
+constexpr uint32_t STRESS_WORLD_WIDTH = 600000;
+constexpr uint32_t STRESS_WORLD_HEIGHT = 512;
+constexpr float STRESS_RADIUS = 4.f;
+constexpr float STRESS_SPEED = 160.f;
+
+constexpr size_t STRESS_SNAPSHOT_OBJECTS = 20000;
+
+constexpr uint32_t STRESS_FIXED_SIDE = 4096;		// fixed point worlds have to fit Q16.16's integer part
+constexpr size_t STRESS_FIXED_OBJECTS = 50000;
+constexpr int STRESS_FIXED_FRAMES = 60;
+
+constexpr uint32_t STRESS_HASH_SIDE = 2048;
+constexpr size_t STRESS_HASH_OBJECTS = 20000;
+constexpr int STRESS_HASH_FRAMES = 60;
+
+constexpr uint32_t STRESS_DETERMINISTIC_SIDE = 2048;
+constexpr size_t STRESS_DETERMINISTIC_OBJECTS = 20000;
+constexpr int STRESS_DETERMINISTIC_FRAMES = 60;
+constexpr uint32_t STRESS_POOL_SIZES[] = { 1, 2, 3, 4, 16 };
+
+// a rewind history sized the way the application sizes its own, run for longer than it holds
+constexpr uint32_t STRESS_REWIND_RATE = 60;
+constexpr uint32_t STRESS_REWIND_SECONDS = 2;
+constexpr size_t STRESS_REWIND_OBJECTS = 2000;
+
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+	std::cout << (condition ? "  [ok]   " : "  [FAIL] ") << description << std::endl;
+	if (!condition) failures++;
+}
+
+static void report(const char* stage, float millis, size_t items) {
+	printf("  %-28s %10.2f ms  %12.0f items/s\n", stage, millis, items / (millis / 1000.f));
+}
+
+
+// gives the stress run the same access to the world that a spawner has
+template <typename Controller>
+class StressController : public Controller {
+public:
+	using Controller::Controller;
+
+	void populate(size_t count, std::mt19937& rng) {
+		std::uniform_real_distribution<float> x(STRESS_RADIUS * 4, STRESS_WORLD_WIDTH - STRESS_RADIUS * 4);
+		std::uniform_real_distribution<float> y(STRESS_RADIUS * 4, STRESS_WORLD_HEIGHT - STRESS_RADIUS * 4);
+		std::uniform_real_distribution<float> v(-STRESS_SPEED, STRESS_SPEED);
+
+		this->stopSpawners();
+		this->spawnObjects(count, [&](size_t) {
+			return Scene::Body{ { x(rng), y(rng) }, { v(rng), v(rng) }, STRESS_RADIUS };
+		});
+	}
+
+	bool idsIncrease() const {
+		for (size_t i = 1; i < this->objects.size(); i++) {
+			if (this->objects[i]->id <= this->objects[i - 1]->id) return false;
+		}
+		return true;
+	}
+
+	bool positionsFinite() const {
+		for (auto obj : this->objects) {
+			if (!std::isfinite(obj->position.x) || !std::isfinite(obj->position.y)) return false;
+		}
+		return true;
+	}
+
+	// every other object, in object order
+	std::vector<PhysicsWorld::ObjectHandle> everyOtherHandle() const {
+		std::vector<PhysicsWorld::ObjectHandle> handles;
+		for (size_t i = 0; i < this->objects.size(); i += 2) handles.push_back(this->objects[i]->handle);
+		return handles;
+	}
+
+	bool handlesResolve() {
+		for (auto obj : this->objects) {
+			if (this->getObject(obj->handle) != obj) return false;
+		}
+		return true;
+	}
+
+	size_t objectsInGrid() {
+		PhysicsWorld::CollisionGrid* grid = this->getBroadPhase().grid;
+		size_t total = 0;
+		for (uint32_t j = 0; j < grid->getHeight(); j++) {
+			for (uint32_t i = 0; i < grid->getWidth(); i++) total += grid->getCell(i, j)->count();
+		}
+		return total;
+	}
+};
+
+
+static void stressGrid(size_t count, std::mt19937& rng) {
+	std::cout << "grid container: " << STRESS_GRID_WIDTH << "x" << STRESS_GRID_HEIGHT << " cells, "
+		<< count + STRESS_PILE << " objects" << std::endl;
+
+	Timer timer;
+	timer.start();
+	PhysicsWorld::CollisionGrid grid(STRESS_GRID_WIDTH, STRESS_GRID_HEIGHT);
+	report("construct", timer.readmarkSplitMillis(), grid.getNumCells());
+
+	float worldWidth = static_cast<float>(STRESS_GRID_WIDTH * grid.getNodeSize());
+	float worldHeight = static_cast<float>(STRESS_GRID_HEIGHT * grid.getNodeSize());
+	// the last column is left to the pile so its count is exact
+	std::uniform_real_distribution<float> x(0.f, worldWidth - grid.getNodeSize() - 1);
+	std::uniform_real_distribution<float> y(0.f, worldHeight - 1);
+
+	std::vector<PhysicsWorld::PhysicsObject*> objects;
+	objects.reserve(count + STRESS_PILE);
+	for (size_t i = 0; i < count; i++) objects.push_back(new PhysicsWorld::PhysicsObject(nullptr, { x(rng), y(rng) }, STRESS_RADIUS, glm::vec2(0)));
+
+	// the pile goes in the last column, so its index only fits in 32 bits
+	glm::vec2 pilePosition = { worldWidth - grid.getNodeSize() / 2.f, grid.getNodeSize() / 2.f };
+	for (uint32_t i = 0; i < STRESS_PILE; i++) objects.push_back(new PhysicsWorld::PhysicsObject(nullptr, pilePosition, STRESS_RADIUS, glm::vec2(0)));
+
+	timer.markSplit();
+	size_t inserted = 0;
+	for (auto obj : objects) inserted += grid.insert(obj);
+	report("insert", timer.readmarkSplitMillis(), objects.size());
+
+	size_t total = 0;
+	uint32_t maximum = 0;
+	for (uint32_t j = 0; j < grid.getHeight(); j++) {
+		for (uint32_t i = 0; i < grid.getWidth(); i++) {
+			total += grid.getCell(i, j)->count();
+			maximum = std::max<uint32_t>(maximum, static_cast<uint32_t>(grid.getCell(i, j)->count()));
+		}
+	}
+	report("count", timer.readmarkSplitMillis(), grid.getNumCells());
+
+	PhysicsWorld::CollisionNode* pile = grid.getCellFromPosition(pilePosition);
+	uint32_t visited = 0;
+	pile->forEach([&visited](PhysicsWorld::PhysicsObject* obj) { visited++; });
+
+	check(grid.getNumCells() == static_cast<size_t>(STRESS_GRID_WIDTH) * STRESS_GRID_HEIGHT, "cell count matches width * height");
+	check(inserted == objects.size(), "every insert landed in a cell");
+	check(total == objects.size(), "cell counts add up to " + std::to_string(objects.size()));
+	check(pile->count() == STRESS_PILE && maximum == STRESS_PILE, "pile cell holds all " + std::to_string(STRESS_PILE) + " objects");
+	check(visited == STRESS_PILE, "pile cell walks " + std::to_string(STRESS_PILE) + " objects");
+	check(pile->index.x == STRESS_GRID_WIDTH - 1 && objects.back()->cell.x == STRESS_GRID_WIDTH - 1, "pile cell index is " + std::to_string(STRESS_GRID_WIDTH - 1));
+
+	timer.markSplit();
+	grid.clear();
+	report("clear", timer.readmarkSplitMillis(), grid.getNumCells());
+
+	total = 0;
+	for (uint32_t j = 0; j < grid.getHeight(); j++) {
+		for (uint32_t i = 0; i < grid.getWidth(); i++) total += grid.getCell(i, j)->count();
+	}
+	check(total == 0, "clear empties every cell");
+
+	for (auto obj : objects) delete obj;
+}
+
+
+// checks that compact particles come back within their quantization error and times a streaming pass over both layouts
+static void stressCompact(size_t count, std::mt19937& rng) {
+	constexpr float CELL = 8.f;
+	std::cout << "compact particles: " << count << " objects" << std::endl;
+
+	std::uniform_real_distribution<float> x(0.f, static_cast<float>(STRESS_WORLD_WIDTH));
+	std::uniform_real_distribution<float> y(0.f, static_cast<float>(STRESS_WORLD_HEIGHT));
+	std::uniform_real_distribution<float> v(-STRESS_SPEED * 3.5f, STRESS_SPEED * 3.5f);
+	std::uniform_int_distribution<int> r(2, 6);
+
+	std::vector<PhysicsWorld::PhysicsObject*> objects;
+	objects.reserve(count);
+	for (size_t i = 0; i < count; i++) objects.push_back(new PhysicsWorld::PhysicsObject(nullptr, { x(rng), y(rng) }, static_cast<float>(r(rng)), { v(rng), v(rng) }));
+
+	Timer timer;
+	timer.start();
+	CompactParticleStore store(CELL);
+	store.reserve(count);
+	for (auto obj : objects) store.push(obj->position, obj->velocity, obj->radius, obj->mass, obj->id);
+	report("pack", timer.readmarkSplitMillis(), count);
+
+	size_t badPositions = 0, badVelocities = 0, badSpecies = 0, badColors = 0;
+	for (size_t i = 0; i < count; i++) {
+		CompactParticleStore::Particle particle = store.get(i);
+		glm::vec2 positionError = glm::abs(particle.position - objects[i]->position);
+		// half a fixed point step, plus the rounding of widening a large coordinate back into a float
+		glm::vec2 positionTolerance = CELL / 65536.f + glm::abs(objects[i]->position) * 2.f * FLT_EPSILON;
+		glm::vec2 velocityError = glm::abs(particle.velocity - objects[i]->velocity);
+		glm::vec2 velocityTolerance = glm::abs(objects[i]->velocity) / 1024.f + 1e-4f;
+
+		badPositions += positionError.x > positionTolerance.x || positionError.y > positionTolerance.y;
+		badVelocities += velocityError.x > velocityTolerance.x || velocityError.y > velocityTolerance.y;
+		badSpecies += particle.radius != objects[i]->radius || particle.mass != objects[i]->mass;
+		badColors += particle.color != colorFromID(objects[i]->id);
+	}
+	report("unpack", timer.readmarkSplitMillis(), count);
+
+	check(store.size() == count, "store holds " + std::to_string(count) + " particles");
+	check(store.numSpecies() == 5, "five radii make five species");
+	check(badPositions == 0, "positions within a fixed point step");
+	check(badVelocities == 0, "velocities within half precision");
+	check(badSpecies == 0, "radius and mass come back from the species table");
+	check(badColors == 0, "colours come back from the ids");
+
+	// the same read-only pass over both layouts, as a bandwidth-bound broad phase or renderer would run it
+	glm::vec2 fullSum(0), compactSum(0);
+	timer.markSplit();
+	for (auto obj : objects) fullSum += obj->position + obj->velocity * (1.f / 60.f);
+	float fullMillis = timer.readmarkSplitMillis();
+	for (size_t i = 0; i < store.size(); i++) compactSum += store.getPosition(i) + store.getVelocity(i) * (1.f / 60.f);
+	float compactMillis = timer.readmarkSplitMillis();
+
+	report("stream full objects", fullMillis, count);
+	report("stream compact", compactMillis, count);
+	printf("  %-28s %10zu bytes / %zu bytes\n", "per particle", sizeof(PhysicsWorld::PhysicsObject) + sizeof(void*), sizeof(CompactParticle));
+	check(glm::length(fullSum - compactSum) < 1e-3f * glm::length(fullSum), "both layouts stream to the same sums");
+
+	for (auto obj : objects) delete obj;
+}
+
+
+// compact snapshots of a live world: colours have to follow the objects through a destroy, and a world with
+// more radii than the species table holds has to fall back to full snapshots
+static void stressCompactSnapshots(size_t count, std::mt19937& rng) {
+	count = std::min(count, STRESS_SNAPSHOT_OBJECTS);
+	std::cout << "compact snapshots: " << count << " objects" << std::endl;
+
+	StressController<DiscreteSerialPhysicsController> controller(STRESS_WORLD_WIDTH, STRESS_WORLD_HEIGHT);
+	controller.setCompactSnapshots(true);
+	controller.populate(count, rng);
+	controller.update(1.f / 60.f);
+
+	// snapshots list the objects in the order readParticles() does, so colours can be keyed by handle
+	PhysicsWorld::ParticleArrays particles;
+	controller.readParticles(particles);
+	const PhysicsWorld::RenderSnapshot* snapshot = &controller.readSnapshot();
+	std::vector<uint32_t> colors;
+	for (size_t i = 0; i < snapshot->compact.size(); i++) {
+		uint32_t slot = particles.handles[i].index;
+		if (slot >= colors.size()) colors.resize(slot + 1);
+		colors[slot] = snapshot->compact.getColor(i);
+	}
+	check(snapshot->compact.size() == count, "snapshot is compact");
+	// every object has to sit in its own cell exactly once, also in a buffer binned over an older frame's cells
+	auto binnedRight = [&](const PhysicsWorld::RenderGrid& grid) {
+		size_t misplaced = 0, binned = 0;
+		for (size_t c = 0; c < grid.cells.size(); c++) {
+			for (uint32_t k = grid.cells[c].first; k < grid.cells[c].first + grid.cells[c].count; k++) {
+				glm::ivec2 cell = glm::floor(particles.positions[grid.objects[k]] / grid.cellSize);
+				cell = glm::clamp(cell, glm::ivec2(0), glm::ivec2(grid.columns - 1, grid.rows - 1));
+				misplaced += static_cast<size_t>(cell.y) * grid.columns + cell.x != c;
+				binned++;
+			}
+		}
+		return misplaced == 0 && binned == particles.size();
+	};
+	check(binnedRight(snapshot->grid), "binning the compact particles puts every object in its own cell");
+
+	controller.destroyObjects(controller.everyOtherHandle());
+	controller.update(1.f / 60.f);
+	controller.readParticles(particles);
+	snapshot = &controller.readSnapshot();
+	size_t changed = 0;
+	for (size_t i = 0; i < snapshot->compact.size(); i++) changed += snapshot->compact.getColor(i) != colors[particles.handles[i].index];
+	check(snapshot->compact.size() == particles.size(), "snapshot after destroy is compact");
+	check(changed == 0, "surviving objects keep their colours");
+	for (int frame = 0; frame < 4; frame++) controller.update(1.f / 60.f);
+	controller.readParticles(particles);
+	check(binnedRight(controller.readSnapshot().grid), "rebinning a reused snapshot leaves no stale cells");
+
+	CompactParticleStore store;
+	size_t pushed = 0;
+	for (size_t i = 0; i <= CompactParticleStore::MAX_SPECIES; i++) pushed += store.push({}, {}, 1.f + i, 1.f, 0);
+	check(pushed == CompactParticleStore::MAX_SPECIES && store.numSpecies() == CompactParticleStore::MAX_SPECIES, "a full species table turns new species away");
+
+	std::uniform_real_distribution<float> x(STRESS_RADIUS * 4, STRESS_WORLD_WIDTH - STRESS_RADIUS * 4);
+	std::uniform_real_distribution<float> y(STRESS_RADIUS * 4, STRESS_WORLD_HEIGHT - STRESS_RADIUS * 4);
+	controller.spawnObjects(CompactParticleStore::MAX_SPECIES, [&](size_t i) {
+		return Scene::Body{ { x(rng), y(rng) }, {}, 1.f + (i + .5f) / 64.f };		// never STRESS_RADIUS, so one more species than fits
+	});
+	controller.update(1.f / 60.f);
+	snapshot = &controller.readSnapshot();
+	check(snapshot->compact.size() == 0 && snapshot->objects.size() == controller.getNumObjects(), "too many species fall back to a full snapshot");
+}
+
+
+template <typename Controller>
+static void stressController(const char* name, size_t count, int frames, std::mt19937& rng) {
+	std::cout << name << ": " << STRESS_WORLD_WIDTH << "x" << STRESS_WORLD_HEIGHT << " world, " << count << " objects, " << frames << " frames" << std::endl;
+
+	Timer timer;
+	timer.start();
+	StressController<Controller> controller(STRESS_WORLD_WIDTH, STRESS_WORLD_HEIGHT);
+	report("construct", timer.readmarkSplitMillis(), 1);
+
+	controller.populate(count, rng);
+	report("populate", timer.readmarkSplitMillis(), count);
+
+	for (int i = 0; i < frames; i++) {
+		controller.update(1.f / 60.f);
+		report(("frame " + std::to_string(i)).c_str(), timer.readmarkSplitMillis(), count);
+	}
+
+	check(controller.getBroadPhase().grid->getWidth() > UINT16_MAX, "grid is " + std::to_string(controller.getBroadPhase().grid->getWidth()) + " cells wide");
+	check(controller.getNumObjects() == count, "object count is " + std::to_string(count));
+	check(controller.idsIncrease(), "object ids are unique and increasing");
+	check(controller.positionsFinite(), "positions are finite");
+	check(controller.objectsInGrid() == count, "cell counts add up to " + std::to_string(count));
+
+	std::vector<PhysicsWorld::ObjectHandle> removed = controller.everyOtherHandle();
+	timer.markSplit();
+	size_t destroyed = controller.destroyObjects(removed);
+	report("destroy half", timer.readmarkSplitMillis(), removed.size());
+	controller.update(1.f / 60.f);
+	report("frame after destroy", timer.readmarkSplitMillis(), count - destroyed);
+
+	size_t stale = 0;
+	for (PhysicsWorld::ObjectHandle handle : removed) stale += controller.getObject(handle) == nullptr;
+	check(destroyed == removed.size() && controller.getNumObjects() == count - destroyed, "destroyed " + std::to_string(removed.size()) + " objects");
+	check(stale == removed.size(), "destroyed handles no longer resolve");
+	check(controller.handlesResolve(), "surviving handles resolve to their objects");
+	check(controller.objectsInGrid() == count - destroyed, "cell counts add up to " + std::to_string(count - destroyed));
+
+	// placement hands every object over to a copy made by the worker of its band
+	PhysicsWorld::ParticleArrays before, after;
+	controller.readParticles(before);
+	timer.markSplit();
+	controller.setThreadPlacement(CpuTopology::COMPACT);
+	report("place memory", timer.readmarkSplitMillis(), count - destroyed);
+	controller.readParticles(after);
+	bool same = before.handles == after.handles && before.positions == after.positions && before.velocities == after.velocities;
+	controller.update(1.f / 60.f);
+	check(same, "placed objects keep their handles and motion");
+	check(controller.handlesResolve(), "handles resolve to the placed objects");
+	check(controller.objectsInGrid() == count - destroyed, "cell counts add up to " + std::to_string(count - destroyed) + " after placement");
+}
+
+
+// two fixed point runs of the same scene have to agree to the last bit
+static void stressFixedPoint(size_t count) {
+	count = std::min(count, STRESS_FIXED_OBJECTS);
+	std::cout << "fixed point: " << STRESS_FIXED_SIDE << "x" << STRESS_FIXED_SIDE << " world, " << count << " objects, " << STRESS_FIXED_FRAMES << " frames, twice" << std::endl;
+	Scene scene;
+	SceneLibrary::make("gas", STRESS_FIXED_SIDE, STRESS_FIXED_SIDE, count, scene);
+
+	PhysicsWorld::ParticleArrays runs[2];
+	Timer timer;
+	timer.start();
+	for (PhysicsWorld::ParticleArrays& particles : runs) {
+		FixedPointPhysicsController controller(STRESS_FIXED_SIDE, STRESS_FIXED_SIDE);
+		controller.loadScene(scene);
+		for (int i = 0; i < STRESS_FIXED_FRAMES; i++) controller.update(1.f / 60.f);
+		controller.readParticles(particles);
+		report("run", timer.readmarkSplitMillis(), particles.size() * STRESS_FIXED_FRAMES);
+	}
+
+	bool identical = runs[0].size() == runs[1].size() &&
+		std::memcmp(runs[0].positions.data(), runs[1].positions.data(), runs[0].size() * sizeof(glm::vec2)) == 0 &&
+		std::memcmp(runs[0].velocities.data(), runs[1].velocities.data(), runs[0].size() * sizeof(glm::vec2)) == 0;
+	size_t inside = 0;
+	for (glm::vec2 position : runs[0].positions) inside += position.x > 0.f && position.y > 0.f && position.x < STRESS_FIXED_SIDE && position.y < STRESS_FIXED_SIDE;
+	check(runs[0].size() == count, "object count is " + std::to_string(count));
+	check(identical, "both runs end on the same bits");
+	check(inside == runs[0].size(), "every object stays inside the world");
+}
+
+
+// The spatial hash on the threaded scheduler against the dense grid on the deterministic one. Both hand
+// out pairs tile by tile in the same order, so they have to find the same contacts every frame and end on
+// the same bits; neighbouring cells resolved at the same time would race on their objects and not.
+static void stressSpatialHash(size_t count) {
+	count = std::min(count, STRESS_HASH_OBJECTS);
+	std::cout << "spatial hash: " << STRESS_HASH_SIDE << "x" << STRESS_HASH_SIDE << " world, " << count << " objects, " << STRESS_HASH_FRAMES << " frames" << std::endl;
+	Scene scene;
+	SceneLibrary::make("pile", STRESS_HASH_SIDE, STRESS_HASH_SIDE, count, scene);
+
+	auto run = [&](auto& controller, std::vector<uint64_t>& contacts, PhysicsWorld::ParticleArrays& particles) {
+		controller.loadScene(scene);
+		for (int i = 0; i < STRESS_HASH_FRAMES; i++) {
+			controller.update(1.f / 60.f);
+			contacts.push_back(controller.getFrameMetrics().contacts);
+		}
+		controller.readParticles(particles);
+	};
+	std::vector<uint64_t> gridContacts, hashContacts;
+	PhysicsWorld::ParticleArrays gridParticles, hashParticles;
+	Timer timer;
+	timer.start();
+	DeterministicPhysicsController grid(STRESS_HASH_SIDE, STRESS_HASH_SIDE);
+	run(grid, gridContacts, gridParticles);
+	report("dense grid", timer.readmarkSplitMillis(), count * STRESS_HASH_FRAMES);
+	SpatialHashPhysicsController hash(STRESS_HASH_SIDE, STRESS_HASH_SIDE);
+	run(hash, hashContacts, hashParticles);
+	report("spatial hash", timer.readmarkSplitMillis(), count * STRESS_HASH_FRAMES);
+
+	bool sameBits = gridParticles.size() == hashParticles.size() &&
+		std::memcmp(gridParticles.positions.data(), hashParticles.positions.data(), gridParticles.size() * sizeof(glm::vec2)) == 0 &&
+		std::memcmp(gridParticles.velocities.data(), hashParticles.velocities.data(), gridParticles.size() * sizeof(glm::vec2)) == 0;
+	check(hash.getNumObjects() == count, "object count is " + std::to_string(count));
+	check(hashContacts == gridContacts, "the hash finds the grid's contacts every frame");
+	check(sameBits, "the hash ends on the grid's bits");
+}
+
+
+// the same pile on every pool size, then the first run again from halfway through its rewind history
+static void stressDeterministic(size_t count) {
+	count = std::min(count, STRESS_DETERMINISTIC_OBJECTS);
+	std::cout << "deterministic: " << STRESS_DETERMINISTIC_SIDE << "x" << STRESS_DETERMINISTIC_SIDE << " world, " << count << " objects, " << STRESS_DETERMINISTIC_FRAMES << " frames on "
+		<< std::size(STRESS_POOL_SIZES) << " pool sizes" << std::endl;
+	Scene scene;
+	SceneLibrary::make("pile", STRESS_DETERMINISTIC_SIDE, STRESS_DETERMINISTIC_SIDE, count, scene);
+
+	auto sameBits = [](const PhysicsWorld::ParticleArrays& a, const PhysicsWorld::ParticleArrays& b) {
+		return a.size() == b.size() &&
+			std::memcmp(a.positions.data(), b.positions.data(), a.size() * sizeof(glm::vec2)) == 0 &&
+			std::memcmp(a.velocities.data(), b.velocities.data(), a.size() * sizeof(glm::vec2)) == 0;
+	};
+
+	PhysicsWorld::ParticleArrays first;
+	PhysicsWorld::ParticleArrays particles;
+	bool identical = true;
+	bool replayed = false;
+	Timer timer;
+	timer.start();
+	for (uint32_t threads : STRESS_POOL_SIZES) {
+		DeterministicPhysicsController controller(STRESS_DETERMINISTIC_SIDE, STRESS_DETERMINISTIC_SIDE);
+		controller.setThreadCount(threads);
+		controller.loadScene(scene);
+		controller.keepRewindHistory(STRESS_DETERMINISTIC_FRAMES, STRESS_DETERMINISTIC_FRAMES / 4);
+		for (int i = 0; i < STRESS_DETERMINISTIC_FRAMES; i++) controller.update(1.f / 60.f);
+		controller.readParticles(particles);
+		report((std::to_string(threads) + " threads").c_str(), timer.readmarkSplitMillis(), particles.size() * STRESS_DETERMINISTIC_FRAMES);
+
+		if (threads != STRESS_POOL_SIZES[0]) {
+			identical &= sameBits(first, particles);
+			continue;
+		}
+		first = particles;
+		replayed = controller.restoreFrame(controller.getNewestRewindFrame() - STRESS_DETERMINISTIC_FRAMES / 2);
+		for (int i = 0; i < STRESS_DETERMINISTIC_FRAMES / 2; i++) controller.update(1.f / 60.f);
+		controller.readParticles(particles);
+		replayed &= sameBits(first, particles);
+		timer.readmarkSplitMillis();
+	}
+
+	check(first.size() == count, "object count is " + std::to_string(count));
+	check(identical, "every pool size ends on the same bits");
+	check(replayed, "a rewound run replays to the same bits");
+}
+
+
+// a history of seconds * rate + 1 frames has to still hold the frame exactly that many seconds back
+static void stressRewindWindow(size_t count, std::mt19937& rng) {
+	count = std::min(count, STRESS_REWIND_OBJECTS);
+	constexpr uint32_t WINDOW = STRESS_REWIND_SECONDS * STRESS_REWIND_RATE;
+	std::cout << "rewind window: " << STRESS_REWIND_SECONDS << " s at " << STRESS_REWIND_RATE << " Hz, " << count << " objects" << std::endl;
+
+	StressController<DiscreteSerialPhysicsController> controller(STRESS_WORLD_WIDTH, STRESS_WORLD_HEIGHT);
+	controller.populate(count, rng);
+	controller.keepRewindHistory(WINDOW + 1, STRESS_REWIND_RATE / 2);
+	for (uint32_t i = 0; i < 2 * WINDOW; i++) controller.update(1.f / STRESS_REWIND_RATE);
+
+	uint64_t boundary = controller.getNewestRewindFrame() - WINDOW;
+	check(controller.getOldestRewindFrame() <= boundary, "the history reaches " + std::to_string(STRESS_REWIND_SECONDS) + " s back");
+	check(controller.restoreFrame(boundary), "the frame " + std::to_string(STRESS_REWIND_SECONDS) + " s back restores");
+}
+
+
+int runStress(int argc, char** argv) {
+	size_t count = argc > 0 ? std::stoull(argv[0]) : DEFAULT_STRESS_OBJECTS;
+	int frames = argc > 1 ? std::stoi(argv[1]) : DEFAULT_STRESS_FRAMES;
+
+	std::mt19937 rng(STRESS_SEED);
+	stressGrid(count, rng);
+	stressCompact(count, rng);
+	stressCompactSnapshots(count, rng);
+	stressController<DiscreteSerialPhysicsController>("discrete serial", count, frames, rng);
+	stressController<DiscretePhysicsController>("discrete threaded", count, frames, rng);
+	stressController<ContinuousSerialPhysicsController>("continuous serial", count, frames, rng);
+	stressController<ContinuousPhysicsController>("continuous threaded", count, frames, rng);
+	stressFixedPoint(count);
+	stressSpatialHash(count);
+	stressDeterministic(count);
+	stressRewindWindow(count, rng);
+
+	std::cout << (failures ? "stress: FAILED (" + std::to_string(failures) + " checks)" : "stress: all checks passed") << std::endl;
+	return failures ? 1 : 0;
+}
@@ -4,22 +4,23 @@
 workspace "Atomos" -- Name of sln file
     configurations { "Debug", "Release" }
     platforms { "Win32", "x64" }
-    toolset "msc"
 
     outputdir = ("bin/%{cfg.buildcfg}/%{cfg.architecture}")
     
     cppdialect "C++20"
 
-    --Set architecture
+    --Set architecture, the system is whatever premake targets (--os) so the core and benchmarks generate on Linux too
     filter { "platforms:Win32" }
-        system "Windows"
         architecture "x86"
     
     filter { "platforms:x64" }
-        system "Windows"
         architecture "x64"
     filter { }
 
+    filter { "system:windows" }
+        toolset "msc"
+    filter { }
+
     filter { "system:windows", "action:gmake2" }
         buildoptions { "--std=c++2a" }
     filter { }
@@ -28,8 +29,12 @@ workspace "Atomos" -- Name of sln file
         include "Atomos/lib/Imgui/Build_ImGui.lua"
 
     group "Core"
+        include "AtomosCore/Build_AtomosCore.lua"
         include "Atomos/Build_Atomos.lua"
 
 
     group "Demo"
         include "Balls/Build_Balls.lua"
+
+    group "Tools"
+        include "Benchmarks/Build_Benchmarks.lua"